@@ -0,0 +1,112 @@
+#include "compile_arena.h"
+#include "native_log.h"
+#include <algorithm>
+#include <cstdlib>
+
+#define LOG_TAG "CompileArena"
+
+namespace Shaderlay {
+
+namespace {
+
+// Memory kept across resets; anything beyond is returned to the system
+constexpr size_t kMaxRetainedBytes = 1024 * 1024;
+
+thread_local CompileArena* t_currentArena = nullptr;
+
+} // namespace
+
+CompileArena::CompileArena(size_t blockSize)
+    : blockSize_(blockSize) {
+}
+
+CompileArena::~CompileArena() {
+    for (auto& block : blocks_) {
+        std::free(block.data);
+    }
+}
+
+void* CompileArena::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    while (true) {
+        if (currentBlock_ < blocks_.size()) {
+            Block& block = blocks_[currentBlock_];
+            size_t aligned = (offset_ + alignment - 1) & ~(alignment - 1);
+            if (aligned + size <= block.size) {
+                offset_ = aligned + size;
+                stats_.bytesUsed += size;
+                stats_.allocationCount++;
+                stats_.peakBytesUsed = std::max(stats_.peakBytesUsed, stats_.bytesUsed);
+                return block.data + aligned;
+            }
+
+            // Move on to a retained block from an earlier job if one is free
+            if (currentBlock_ + 1 < blocks_.size() && blocks_[currentBlock_ + 1].size >= size + alignment) {
+                currentBlock_++;
+                offset_ = 0;
+                continue;
+            }
+        }
+
+        addBlock(size + alignment);
+    }
+}
+
+void CompileArena::reset() {
+    // Keep the earliest blocks up to the retention cap
+    size_t retained = 0;
+    size_t keep = 0;
+    while (keep < blocks_.size() && retained + blocks_[keep].size <= kMaxRetainedBytes) {
+        retained += blocks_[keep].size;
+        keep++;
+    }
+    for (size_t i = keep; i < blocks_.size(); ++i) {
+        std::free(blocks_[i].data);
+    }
+    blocks_.resize(keep);
+
+    currentBlock_ = 0;
+    offset_ = 0;
+    stats_.bytesUsed = 0;
+    stats_.allocationCount = 0;
+    stats_.reservedBytes = retained;
+}
+
+ArenaStats CompileArena::getStats() const {
+    return stats_;
+}
+
+void CompileArena::addBlock(size_t minimumSize) {
+    Block block;
+    block.size = std::max(blockSize_, minimumSize);
+    block.data = static_cast<char*>(std::malloc(block.size));
+    if (!block.data) {
+        LOGE("Arena block allocation failed (%zu bytes)", block.size);
+        throw std::bad_alloc();
+    }
+
+    // Insert after the current block so retained blocks stay in order
+    size_t position = blocks_.empty() ? 0 : currentBlock_ + 1;
+    blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(position), block);
+    currentBlock_ = position;
+    offset_ = 0;
+    stats_.reservedBytes += block.size;
+}
+
+ArenaScope::ArenaScope(CompileArena& arena)
+    : previous_(t_currentArena) {
+    t_currentArena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    t_currentArena = previous_;
+}
+
+CompileArena* currentArena() {
+    return t_currentArena;
+}
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstddef>
+#include <new>
+
+namespace Shaderlay {
+
+struct ArenaStats {
+    size_t bytesUsed = 0;             // Since the last reset; the job's high-water mark
+    size_t allocationCount = 0;       // Since the last reset
+    size_t peakBytesUsed = 0;         // Largest bytesUsed over the arena's lifetime
+    size_t reservedBytes = 0;         // Currently held from the system
+};
+
+// Monotonic bump allocator for one compile job. Individual frees are
+// no-ops; everything is released at once by reset(). Blocks are kept
+// across resets (up to a cap) so a long-running service stops hitting
+// the system allocator once warmed up.
+class CompileArena {
+public:
+    explicit CompileArena(size_t blockSize = 64 * 1024);
+    ~CompileArena();
+
+    CompileArena(const CompileArena&) = delete;
+    CompileArena& operator=(const CompileArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment);
+    void reset();
+
+    ArenaStats getStats() const;
+
+private:
+    struct Block {
+        char* data = nullptr;
+        size_t size = 0;
+    };
+
+    void addBlock(size_t minimumSize);
+
+    size_t blockSize_;
+    std::vector<Block> blocks_;
+    size_t currentBlock_ = 0;
+    size_t offset_ = 0;
+    ArenaStats stats_;
+};
+
+// Makes arena the allocation source for ArenaAllocator on this thread
+// until the scope ends
+class ArenaScope {
+public:
+    explicit ArenaScope(CompileArena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    CompileArena* previous_;
+};
+
+// Arena active on the calling thread, or nullptr
+CompileArena* currentArena();
+
+// Standard allocator bound to the thread's current arena at construction.
+// Falls back to the global heap outside an ArenaScope.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena_(currentArena()) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_t n) {
+        if (arena_) {
+            return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        if (!arena_) {
+            ::operator delete(p);
+        }
+    }
+
+    CompileArena* arena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena_ != other.arena(); }
+
+private:
+    CompileArena* arena_;
+};
+
+// Scratch containers for the parse/translate pipeline. They must not
+// outlive the ArenaScope they were created in; convert to std::string
+// before returning results to callers.
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename K, typename V>
+using ArenaMap = std::map<K, V, std::less<>, ArenaAllocator<std::pair<const K, V>>>;
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "compile_scheduler.h"
+#include "shader_compiler.h"
+#include "native_log.h"
+#include <algorithm>
+#include <exception>
+
+#define LOG_TAG "CompileScheduler"
+
+namespace Shaderlay {
+
+CompileScheduler::CompileScheduler(unsigned workerCount) {
+    workerCount = std::max(1u, workerCount);
+    for (unsigned i = 0; i < workerCount; ++i) {
+        workers_.emplace_back(&CompileScheduler::workerLoop, this);
+    }
+    LOGD("CompileScheduler started with %u workers", workerCount);
+}
+
+CompileScheduler::~CompileScheduler() {
+    shutdown();
+}
+
+uint64_t CompileScheduler::submit(const std::string& presetContent, std::vector<std::string> passSources,
+                                  int priority, PassCallback onPass, FinishCallback onFinish) {
+    auto job = std::make_shared<Job>();
+    job->priority = priority;
+    job->presetContent = presetContent;
+    job->passSources = std::move(passSources);
+    job->onPass = std::move(onPass);
+    job->onFinish = std::move(onFinish);
+    job->submitted = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job->ticket = nextTicket_++;
+        queue_.push_back(job);
+        jobs_[job->ticket] = job;
+    }
+
+    wake_.notify_one();
+    return job->ticket;
+}
+
+bool CompileScheduler::cancel(uint64_t ticket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(ticket);
+    if (it == jobs_.end()) {
+        return false;
+    }
+
+    it->second->cancelled = true;
+    return true;
+}
+
+void CompileScheduler::cancelAllExcept(uint64_t ticket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : jobs_) {
+        if (entry.first != ticket) {
+            entry.second->cancelled = true;
+        }
+    }
+}
+
+void CompileScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        for (auto& entry : jobs_) {
+            entry.second->cancelled = true;
+        }
+    }
+
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+ArenaStats CompileScheduler::getLastArenaStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastArenaStats_;
+}
+
+std::vector<int> CompileScheduler::compileOrder(const SlangPreset& preset) {
+    std::vector<int> order;
+    int passCount = static_cast<int>(preset.shaders.size());
+    if (passCount == 0) {
+        return order;
+    }
+
+    order.push_back(passCount - 1);
+    for (int i = 0; i < passCount - 1; ++i) {
+        order.push_back(i);
+    }
+    return order;
+}
+
+void CompileScheduler::workerLoop() {
+    // Reused across jobs so a warmed-up worker rarely touches the heap
+    CompileArena arena;
+
+    while (true) {
+        std::shared_ptr<Job> job = takeNextJob();
+        if (!job) {
+            return;
+        }
+
+        CompileStatus status = CompileStatus::Cancelled;
+        std::string message;
+        if (!job->cancelled) {
+            // A throwing job must not take the worker down with it; it
+            // still finishes so the listener is released
+            ArenaScope scope(arena);
+            try {
+                status = runJob(*job, message);
+            } catch (const std::exception& e) {
+                LOGE("Job %llu failed: %s", static_cast<unsigned long long>(job->ticket), e.what());
+                status = CompileStatus::Failed;
+                message = e.what();
+            }
+        }
+
+        ArenaStats stats = arena.getStats();
+        arena.reset();
+        LOGD("Job %llu: arena high-water %zu bytes over %zu allocations",
+             static_cast<unsigned long long>(job->ticket), stats.bytesUsed, stats.allocationCount);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.erase(job->ticket);
+            lastArenaStats_ = stats;
+        }
+
+        if (job->onFinish) {
+            job->onFinish(job->ticket, status, message);
+        }
+    }
+}
+
+std::shared_ptr<CompileScheduler::Job> CompileScheduler::takeNextJob() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+
+    if (queue_.empty()) {
+        return nullptr;
+    }
+
+    // Highest priority first; on ties the most recent submission wins
+    auto best = queue_.begin();
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+        if ((*it)->priority > (*best)->priority ||
+            ((*it)->priority == (*best)->priority && (*it)->ticket > (*best)->ticket)) {
+            best = it;
+        }
+    }
+
+    std::shared_ptr<Job> job = *best;
+    queue_.erase(best);
+    return job;
+}
+
+CompileStatus CompileScheduler::runJob(Job& job, std::string& message) {
+    // Each job owns its parser and compiler; neither is thread-safe
+    SlangParser parser;
+    if (!parser.parseSlangPreset(job.presetContent)) {
+        LOGE("Job %llu: preset parsing failed", static_cast<unsigned long long>(job.ticket));
+        message = "Preset parsing failed";
+        return CompileStatus::Failed;
+    }
+
+    if (job.passSources.size() < parser.getPreset().shaders.size()) {
+        LOGE("Job %llu: %zu pass sources for %zu passes", static_cast<unsigned long long>(job.ticket),
+             job.passSources.size(), parser.getPreset().shaders.size());
+        message = "Missing pass sources";
+        return CompileStatus::Failed;
+    }
+
+    ShaderCompiler compiler;
+    compiler.initialize();
+
+    SlangPreset preset = parser.getPreset();
+    bool first = true;
+
+    for (int index : compileOrder(preset)) {
+        if (job.cancelled) {
+            LOGD("Job %llu cancelled before pass %d", static_cast<unsigned long long>(job.ticket), index);
+            return CompileStatus::Cancelled;
+        }
+
+        CompiledPass pass;
+        pass.index = index;
+        pass.fragmentSource = compiler.compileSlangPass(job.passSources[index]);
+
+        if (pass.fragmentSource.empty()) {
+            LOGE("Job %llu: pass %d failed to compile", static_cast<unsigned long long>(job.ticket), index);
+            message = "Pass " + std::to_string(index) + " failed to compile";
+            return CompileStatus::Failed;
+        }
+
+        if (first) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - job.submitted);
+            LOGI("Job %llu: first pass ready after %lld ms",
+                 static_cast<unsigned long long>(job.ticket), static_cast<long long>(elapsed.count()));
+            first = false;
+        }
+
+        if (job.onPass) {
+            job.onPass(job.ticket, pass);
+        }
+    }
+
+    return CompileStatus::Completed;
+}
+
+} // namespace Shaderlay
\ No newline at end of file
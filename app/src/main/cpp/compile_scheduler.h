@@ -0,0 +1,87 @@
+#pragma once
+
+#include "compile_arena.h"
+#include "slang_parser.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Shaderlay {
+
+enum class CompileStatus {
+    Completed = 0,
+    Cancelled = 1,
+    Failed = 2
+};
+
+struct CompiledPass {
+    int index = 0;
+    std::string fragmentSource;
+};
+
+// Background preset compilation. Each submitted preset comes with one
+// source per pass, already resolved by the caller, and gets a ticket; the
+// highest-priority job runs first (newest wins ties) and cancellation is
+// checked between passes, so a superseded preset stops after at most one
+// more pass. Parser and compiler scratch allocations come from a
+// per-worker arena that is reset after every job.
+class CompileScheduler {
+public:
+    using PassCallback = std::function<void(uint64_t ticket, const CompiledPass& pass)>;
+    // message describes a failure and is empty otherwise
+    using FinishCallback = std::function<void(uint64_t ticket, CompileStatus status,
+                                              const std::string& message)>;
+
+    explicit CompileScheduler(unsigned workerCount = 1);
+    ~CompileScheduler();
+
+    uint64_t submit(const std::string& presetContent, std::vector<std::string> passSources,
+                    int priority, PassCallback onPass, FinishCallback onFinish);
+
+    bool cancel(uint64_t ticket);
+    // Cancel every job except ticket, e.g. when the user moves on
+    void cancelAllExcept(uint64_t ticket);
+
+    void shutdown();
+
+    // Scratch memory used by the most recently finished job
+    ArenaStats getLastArenaStats();
+
+    // Final pass first so a first frame can be shown early, then the chain in order
+    static std::vector<int> compileOrder(const SlangPreset& preset);
+
+private:
+    struct Job {
+        uint64_t ticket = 0;
+        int priority = 0;
+        std::string presetContent;
+        std::vector<std::string> passSources;
+        PassCallback onPass;
+        FinishCallback onFinish;
+        std::atomic<bool> cancelled{false};
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    void workerLoop();
+    std::shared_ptr<Job> takeNextJob();
+    CompileStatus runJob(Job& job, std::string& message);
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<std::shared_ptr<Job>> queue_;
+    std::unordered_map<uint64_t, std::shared_ptr<Job>> jobs_;
+    std::vector<std::thread> workers_;
+    uint64_t nextTicket_ = 1;
+    bool stopping_ = false;
+    ArenaStats lastArenaStats_;
+};
+
+} // namespace Shaderlay
\ No newline at end of file
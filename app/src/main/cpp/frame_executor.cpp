@@ -0,0 +1,552 @@
+#include "frame_executor.h"
+#include "native_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+
+#define LOG_TAG "FrameExecutor"
+
+namespace Shaderlay {
+
+namespace {
+
+// Shared by every pass; fragment stages read v_TexCoord
+const char* const kVertexShader = R"(
+#version 100
+attribute vec4 a_Position;
+attribute vec2 a_TexCoord;
+varying vec2 v_TexCoord;
+
+void main() {
+    gl_Position = a_Position;
+    v_TexCoord = a_TexCoord;
+}
+)";
+
+// FNV-1a; identical translated sources share a program and identical
+// lookup images share a texture
+uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t hashSource(const std::string& source) {
+    return hashBytes(reinterpret_cast<const uint8_t*>(source.data()), source.size());
+}
+
+uint64_t hashImage(const LookupImage& image, bool filterLinear) {
+    int shape[3] = {image.width, image.height, filterLinear ? 1 : 0};
+    uint64_t hash = hashBytes(image.pixels.data(), image.pixels.size());
+    return hashBytes(reinterpret_cast<const uint8_t*>(shape), sizeof(shape), hash);
+}
+
+} // namespace
+
+FrameExecutor::FrameExecutor(std::unique_ptr<RenderBackend> backend)
+    : backend_(std::move(backend)) {
+}
+
+FrameExecutor::~FrameExecutor() {
+    release();
+}
+
+bool FrameExecutor::build(const SlangPreset& preset, const std::vector<std::string>& fragmentSources,
+                          int viewportWidth, int viewportHeight,
+                          const std::vector<LookupImage>& lookupImages) {
+    if (preset.shaders.empty() || fragmentSources.size() < preset.shaders.size()) {
+        LOGE("Chain needs %zu pass sources, got %zu", preset.shaders.size(), fragmentSources.size());
+        release();
+        return false;
+    }
+
+    BuildStats stats;
+    stats.passes = static_cast<int>(preset.shaders.size());
+
+    std::vector<PassBinding> previous = std::move(passes_);
+    passes_.clear();
+    passes_.resize(preset.shaders.size());
+
+    std::vector<uint64_t> hashes(passes_.size());
+    for (size_t i = 0; i < passes_.size(); ++i) {
+        hashes[i] = hashSource(fragmentSources[i]);
+    }
+
+    // Leading passes that are unchanged keep their program, locations and
+    // target; createTargets() re-checks the target against the new chain
+    size_t prefix = 0;
+    while (prefix < passes_.size() && prefix < previous.size() &&
+           samePass(previous[prefix], preset.shaders[prefix], hashes[prefix])) {
+        passes_[prefix] = previous[prefix];
+        prefix++;
+    }
+    stats.reusedPasses = static_cast<int>(prefix);
+    stats.reusedPrograms = static_cast<int>(prefix);
+
+    std::vector<RenderTarget> spare;
+    for (size_t i = prefix; i < previous.size(); ++i) {
+        if (previous[i].target.framebuffer != 0) {
+            spare.push_back(previous[i].target);
+        }
+        cacheProgram(previous[i]);
+    }
+
+    if (quad_ == 0) {
+        quad_ = backend_->createQuad();
+    }
+
+    for (size_t i = prefix; i < passes_.size(); ++i) {
+        const SlangShader& shader = preset.shaders[i];
+        PassBinding& pass = passes_[i];
+
+        if (takeCachedProgram(hashes[i], pass)) {
+            stats.reusedPrograms++;
+        } else if (createProgram(fragmentSources[i], pass)) {
+            stats.compiledPrograms++;
+        } else {
+            LOGE("Pass %zu (%s) failed to build", i, shader.path.c_str());
+            for (const auto& target : spare) {
+                backend_->destroyRenderTarget(target);
+            }
+            release();
+            return false;
+        }
+
+        pass.sourceHash = hashes[i];
+        pass.filterLinear = shader.filterLinear;
+        pass.scaleTypeX = shader.scaleTypeX;
+        pass.scaleTypeY = shader.scaleTypeY;
+        pass.scaleX = shader.scaleX;
+        pass.scaleY = shader.scaleY;
+        pass.floatFramebuffer = shader.floatFramebuffer;
+        pass.srgbFramebuffer = shader.srgbFramebuffer;
+    }
+    trimProgramCache(kMaxCachedPrograms);
+
+    viewportWidth_ = viewportWidth;
+    viewportHeight_ = viewportHeight;
+    if (!createTargets(spare, stats) || !updateLookupTextures(preset, lookupImages, stats)) {
+        release();
+        return false;
+    }
+
+    applyStaticUniforms();
+
+    frameCount_ = 0;
+    totalCpuMs_ = 0.0;
+    lastFrame_ = FrameStats{};
+    lastBuild_ = stats;
+
+    LOGI("Built %zu-pass chain at %dx%d: %d passes kept, %d programs compiled, %d targets created, "
+         "%d of %zu textures uploaded",
+         passes_.size(), viewportWidth, viewportHeight,
+         stats.reusedPasses, stats.compiledPrograms, stats.createdTargets,
+         stats.createdTextures, lookups_.size());
+    return true;
+}
+
+bool FrameExecutor::resize(int viewportWidth, int viewportHeight) {
+    if (passes_.empty()) {
+        return false;
+    }
+    if (viewportWidth == viewportWidth_ && viewportHeight == viewportHeight_) {
+        return true;
+    }
+
+    viewportWidth_ = viewportWidth;
+    viewportHeight_ = viewportHeight;
+
+    // Passes with absolute scales keep their targets
+    std::vector<RenderTarget> spare;
+    BuildStats stats;
+    if (!createTargets(spare, stats)) {
+        release();
+        return false;
+    }
+
+    applyStaticUniforms();
+    return true;
+}
+
+void FrameExecutor::renderFrame(const FrameInputs& inputs) {
+    if (passes_.empty()) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FrameStats frame;
+    float frameIndex = static_cast<float>(frameCount_);
+
+    backend_->beginFrame();
+    backend_->bindQuad(quad_);
+    frame.stateCalls++;
+
+    for (size_t i = 0; i < passes_.size(); ++i) {
+        PassBinding& pass = passes_[i];
+        bool last = (i + 1 == passes_.size());
+
+        // Intermediate passes overwrite their whole target; only the
+        // overlay itself is cleared and blended
+        backend_->bindFramebuffer(last ? 0 : pass.target.framebuffer, pass.width, pass.height);
+        backend_->setBlending(last);
+        if (last) {
+            backend_->clear();
+        }
+        backend_->useProgram(pass.program);
+
+        // Always bound, 0 included: the first pass has no input, and the
+        // texture left on unit 0 by the last frame may be this pass's own
+        // target, which GL forbids sampling while rendering into it
+        backend_->bindTexture(0, pass.inputTexture);
+        frame.stateCalls += 4;
+
+        // Every pass rebinds its lookups; the backend drops all but the
+        // first bind of a frame
+        for (size_t unit = 0; unit < pass.lookupLocations.size(); ++unit) {
+            if (pass.lookupLocations[unit] >= 0) {
+                backend_->bindTexture(static_cast<int>(unit + 1), lookups_[unit].texture);
+                frame.stateCalls++;
+            }
+        }
+
+        if (pass.timeLocation >= 0) {
+            backend_->setUniform1f(pass.timeLocation, inputs.timeSeconds);
+            frame.uniformCalls++;
+        }
+        if (pass.frameCountLocation >= 0) {
+            backend_->setUniform1f(pass.frameCountLocation, frameIndex);
+            frame.uniformCalls++;
+        }
+        if (pass.opacityLocation >= 0 && pass.lastOpacity != inputs.opacity) {
+            backend_->setUniform1f(pass.opacityLocation, inputs.opacity);
+            pass.lastOpacity = inputs.opacity;
+            frame.uniformCalls++;
+        }
+
+        backend_->drawQuad();
+        frame.drawCalls++;
+    }
+
+    backend_->endFrame();
+
+    frameCount_++;
+    frame.frames = frameCount_;
+    frame.passes = static_cast<int>(passes_.size());
+    frame.lastCpuMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    totalCpuMs_ += frame.lastCpuMs;
+    frame.averageCpuMs = totalCpuMs_ / static_cast<double>(frameCount_);
+    lastFrame_ = frame;
+}
+
+void FrameExecutor::release(bool contextLost) {
+    if (!contextLost) {
+        destroyTargets();
+        for (auto& pass : passes_) {
+            if (pass.program != 0) {
+                backend_->destroyProgram(pass.program);
+            }
+        }
+        trimProgramCache(0);
+        destroyLookupTextures();
+        if (quad_ != 0) {
+            backend_->destroyQuad(quad_);
+        }
+    }
+
+    passes_.clear();
+    programCache_.clear();
+    lookups_.clear();
+    quad_ = 0;
+    frameCount_ = 0;
+    totalCpuMs_ = 0.0;
+    lastFrame_ = FrameStats{};
+    lastBuild_ = BuildStats{};
+}
+
+bool FrameExecutor::isReady() const {
+    return !passes_.empty();
+}
+
+FrameStats FrameExecutor::getStats() const {
+    return lastFrame_;
+}
+
+BuildStats FrameExecutor::getLastBuildStats() const {
+    return lastBuild_;
+}
+
+RenderBackend& FrameExecutor::getBackend() {
+    return *backend_;
+}
+
+bool FrameExecutor::createProgram(const std::string& fragmentSource, PassBinding& pass) {
+    pass.program = backend_->createProgram(kVertexShader, fragmentSource);
+    if (pass.program == 0) {
+        return false;
+    }
+
+    pass.timeLocation = backend_->uniformLocation(pass.program, "u_Time");
+    pass.frameCountLocation = backend_->uniformLocation(pass.program, "u_FrameCount");
+    pass.opacityLocation = backend_->uniformLocation(pass.program, "u_Opacity");
+    pass.resolutionLocation = backend_->uniformLocation(pass.program, "u_Resolution");
+    pass.sourceSizeLocation = backend_->uniformLocation(pass.program, "u_SourceSize");
+    pass.outputSizeLocation = backend_->uniformLocation(pass.program, "u_OutputSize");
+
+    pass.samplerLocation = backend_->uniformLocation(pass.program, "Source");
+    if (pass.samplerLocation < 0) {
+        pass.samplerLocation = backend_->uniformLocation(pass.program, "u_Texture");
+    }
+    return true;
+}
+
+void FrameExecutor::cacheProgram(const PassBinding& pass) {
+    if (pass.program == 0) {
+        return;
+    }
+
+    // Static uniforms are reapplied on reuse, so only program and
+    // locations matter
+    PassBinding cached = pass;
+    cached.target = RenderTarget{};
+    cached.inputTexture = 0;
+    programCache_.push_back(cached);
+}
+
+bool FrameExecutor::takeCachedProgram(uint64_t sourceHash, PassBinding& pass) {
+    // Newest first; a program serves one pass since static uniforms differ
+    for (auto it = programCache_.rbegin(); it != programCache_.rend(); ++it) {
+        if (it->sourceHash == sourceHash) {
+            pass = *it;
+            programCache_.erase(std::next(it).base());
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameExecutor::trimProgramCache(size_t limit) {
+    if (programCache_.size() <= limit) {
+        return;
+    }
+
+    size_t excess = programCache_.size() - limit;
+    for (size_t i = 0; i < excess; ++i) {
+        backend_->destroyProgram(programCache_[i].program);
+    }
+    programCache_.erase(programCache_.begin(), programCache_.begin() + excess);
+}
+
+bool FrameExecutor::createTargets(std::vector<RenderTarget>& spare, BuildStats& stats) {
+    // Every current target becomes a candidate; contents are redrawn each
+    // frame, so any target of the right size and filter will do
+    for (auto& pass : passes_) {
+        if (pass.target.framebuffer != 0) {
+            spare.push_back(pass.target);
+            pass.target = RenderTarget{};
+        }
+    }
+
+    // The overlay has no game frame, so the chain starts at viewport size
+    int width = viewportWidth_;
+    int height = viewportHeight_;
+    uint32_t input = 0;
+    bool created = true;
+
+    for (size_t i = 0; i < passes_.size(); ++i) {
+        PassBinding& pass = passes_[i];
+        pass.inputTexture = input;
+
+        if (i + 1 == passes_.size()) {
+            pass.width = viewportWidth_;
+            pass.height = viewportHeight_;
+            break;
+        }
+
+        width = scaledSize(pass.scaleTypeX, pass.scaleX, width, viewportWidth_);
+        height = scaledSize(pass.scaleTypeY, pass.scaleY, height, viewportHeight_);
+        bool filterLinear = passes_[i + 1].filterLinear;
+
+        auto match = std::find_if(spare.begin(), spare.end(), [&](const RenderTarget& target) {
+            return target.width == width && target.height == height && target.filterLinear == filterLinear;
+        });
+        if (match != spare.end()) {
+            pass.target = *match;
+            *match = spare.back();
+            spare.pop_back();
+            stats.reusedTargets++;
+        } else if (backend_->createRenderTarget(width, height, filterLinear, pass.target)) {
+            stats.createdTargets++;
+        } else {
+            LOGE("Pass %zu: failed to create %dx%d target", i, width, height);
+            created = false;
+            break;
+        }
+
+        pass.width = width;
+        pass.height = height;
+        input = pass.target.texture;
+    }
+
+    for (const auto& target : spare) {
+        backend_->destroyRenderTarget(target);
+    }
+    spare.clear();
+    return created;
+}
+
+void FrameExecutor::destroyTargets() {
+    for (auto& pass : passes_) {
+        if (pass.target.framebuffer != 0) {
+            backend_->destroyRenderTarget(pass.target);
+            pass.target = RenderTarget{};
+        }
+        pass.inputTexture = 0;
+    }
+}
+
+bool FrameExecutor::updateLookupTextures(const SlangPreset& preset, const std::vector<LookupImage>& images,
+                                         BuildStats& stats) {
+    std::vector<LookupTexture> previous = std::move(lookups_);
+    lookups_.clear();
+    bool created = true;
+
+    for (const auto& declared : preset.textures) {
+        auto image = std::find_if(images.begin(), images.end(), [&](const LookupImage& candidate) {
+            return candidate.name == declared.name;
+        });
+        if (image == images.end()) {
+            LOGW("Texture %s (%s) has no image", declared.name.c_str(), declared.path.c_str());
+            continue;
+        }
+        size_t expected = static_cast<size_t>(std::max(image->width, 0)) * std::max(image->height, 0) * 4;
+        if (expected == 0 || image->pixels.size() != expected) {
+            LOGW("Texture %s: %zu bytes for %dx%d RGBA", declared.name.c_str(),
+                 image->pixels.size(), image->width, image->height);
+            continue;
+        }
+        if (lookups_.size() == kMaxLookupTextures) {
+            LOGW("Texture %s dropped: only %zu lookup textures can be bound",
+                 declared.name.c_str(), kMaxLookupTextures);
+            continue;
+        }
+
+        LookupTexture lookup;
+        lookup.name = declared.name;
+        lookup.contentHash = hashImage(*image, declared.filterLinear);
+
+        auto match = std::find_if(previous.begin(), previous.end(), [&](const LookupTexture& old) {
+            return old.texture != 0 && old.contentHash == lookup.contentHash;
+        });
+        if (match != previous.end()) {
+            lookup.texture = match->texture;
+            match->texture = 0;
+            stats.reusedTextures++;
+        } else {
+            lookup.texture = backend_->createTexture(image->width, image->height, image->pixels.data(),
+                                                     declared.filterLinear);
+            if (lookup.texture == 0) {
+                LOGE("Texture %s: failed to upload %dx%d", declared.name.c_str(), image->width, image->height);
+                created = false;
+                break;
+            }
+            stats.createdTextures++;
+        }
+        lookups_.push_back(std::move(lookup));
+    }
+
+    for (const auto& old : previous) {
+        if (old.texture != 0) {
+            backend_->destroyTexture(old.texture);
+        }
+    }
+    if (!created) {
+        return false;
+    }
+
+    // Kept and cached programs were resolved against the previous list
+    for (auto& pass : passes_) {
+        pass.lookupLocations.clear();
+        for (const auto& lookup : lookups_) {
+            pass.lookupLocations.push_back(backend_->uniformLocation(pass.program, lookup.name.c_str()));
+        }
+    }
+    return true;
+}
+
+void FrameExecutor::destroyLookupTextures() {
+    for (const auto& lookup : lookups_) {
+        backend_->destroyTexture(lookup.texture);
+    }
+    lookups_.clear();
+}
+
+void FrameExecutor::applyStaticUniforms() {
+    backend_->beginFrame();
+
+    int sourceWidth = viewportWidth_;
+    int sourceHeight = viewportHeight_;
+    for (auto& pass : passes_) {
+        backend_->useProgram(pass.program);
+
+        float width = static_cast<float>(pass.width);
+        float height = static_cast<float>(pass.height);
+        if (pass.resolutionLocation >= 0) {
+            backend_->setUniform2f(pass.resolutionLocation, width, height);
+        }
+        if (pass.outputSizeLocation >= 0) {
+            backend_->setUniform4f(pass.outputSizeLocation, width, height, 1.0f / width, 1.0f / height);
+        }
+        if (pass.sourceSizeLocation >= 0) {
+            backend_->setUniform4f(pass.sourceSizeLocation,
+                                   static_cast<float>(sourceWidth), static_cast<float>(sourceHeight),
+                                   1.0f / sourceWidth, 1.0f / sourceHeight);
+        }
+        if (pass.samplerLocation >= 0) {
+            backend_->setUniform1i(pass.samplerLocation, 0);
+        }
+        for (size_t unit = 0; unit < pass.lookupLocations.size(); ++unit) {
+            if (pass.lookupLocations[unit] >= 0) {
+                backend_->setUniform1i(pass.lookupLocations[unit], static_cast<int>(unit + 1));
+            }
+        }
+
+        pass.lastOpacity = -1.0f;
+        sourceWidth = pass.width;
+        sourceHeight = pass.height;
+    }
+}
+
+bool FrameExecutor::samePass(const PassBinding& pass, const SlangShader& shader, uint64_t sourceHash) {
+    return pass.program != 0 &&
+           pass.sourceHash == sourceHash &&
+           pass.filterLinear == shader.filterLinear &&
+           pass.scaleTypeX == shader.scaleTypeX &&
+           pass.scaleTypeY == shader.scaleTypeY &&
+           pass.scaleX == shader.scaleX &&
+           pass.scaleY == shader.scaleY &&
+           pass.floatFramebuffer == shader.floatFramebuffer &&
+           pass.srgbFramebuffer == shader.srgbFramebuffer;
+}
+
+int FrameExecutor::scaledSize(ScaleType type, float scale, int previous, int viewport) {
+    float size;
+    switch (type) {
+        case ScaleType::Viewport:
+            size = viewport * scale;
+            break;
+        case ScaleType::Absolute:
+            size = scale;
+            break;
+        case ScaleType::Source:
+        default:
+            size = previous * scale;
+            break;
+    }
+    return std::max(1, static_cast<int>(std::lround(size)));
+}
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "render_backend.h"
+#include "slang_parser.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Shaderlay {
+
+struct FrameInputs {
+    float timeSeconds = 0.0f;
+    float opacity = 1.0f;
+};
+
+struct FrameStats {
+    uint64_t frames = 0;
+    int passes = 0;
+
+    // Backend calls issued by the most recent frame
+    int drawCalls = 0;
+    int stateCalls = 0;
+    int uniformCalls = 0;
+
+    double lastCpuMs = 0.0;
+    double averageCpuMs = 0.0;
+};
+
+// Decoded image of a preset's lookup texture, tightly packed RGBA8 rows
+struct LookupImage {
+    std::string name;             // As in the preset's textures list
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+struct BuildStats {
+    int passes = 0;
+    int reusedPasses = 0;         // Unchanged prefix kept as it was
+    int reusedPrograms = 0;       // Prefix passes plus program cache hits
+    int compiledPrograms = 0;
+    int reusedTargets = 0;
+    int createdTargets = 0;
+    int reusedTextures = 0;       // Lookup textures kept from the previous chain
+    int createdTextures = 0;
+};
+
+// Runs a whole preset chain per frame. Programs, render targets and
+// uniform locations are resolved once into per-pass binding tables, so a
+// frame only switches program and input texture per pass and updates the
+// uniforms that actually change.
+//
+// Building over an existing chain is incremental: the leading passes
+// whose source, scale and format are unchanged are kept as they are,
+// programs of dropped passes are parked in a small cache keyed by source
+// hash, and render targets of matching size and filter are recycled.
+// Switching between presets that share a prefix only compiles the rest.
+// Lookup textures with unchanged pixels and filter are kept as well, so
+// tiers of one look that share their LUTs upload them only once.
+class FrameExecutor {
+public:
+    explicit FrameExecutor(std::unique_ptr<RenderBackend> backend);
+    ~FrameExecutor();
+
+    // fragmentSources are translated GLSL ES, one per preset pass.
+    // lookupImages are matched to preset.textures by name and bound to
+    // every pass sampling them; declared textures without an image stay
+    // unbound. On failure the whole chain, including reused parts, is
+    // released.
+    bool build(const SlangPreset& preset, const std::vector<std::string>& fragmentSources,
+               int viewportWidth, int viewportHeight,
+               const std::vector<LookupImage>& lookupImages = {});
+    bool resize(int viewportWidth, int viewportHeight);
+    void renderFrame(const FrameInputs& inputs);
+
+    // With contextLost the objects died with their GL context and are
+    // only forgotten; deleting them could hit reused names
+    void release(bool contextLost = false);
+
+    bool isReady() const;
+    FrameStats getStats() const;
+    BuildStats getLastBuildStats() const;
+    RenderBackend& getBackend();
+
+private:
+    struct PassBinding {
+        uint64_t sourceHash = 0;
+        uint32_t program = 0;
+        RenderTarget target;          // Unused by the final pass, which draws to the screen
+        uint32_t inputTexture = 0;    // Previous pass output; 0 for the first pass
+        bool filterLinear = true;
+        ScaleType scaleTypeX = ScaleType::Source;
+        ScaleType scaleTypeY = ScaleType::Source;
+        float scaleX = 1.0f;
+        float scaleY = 1.0f;
+        bool floatFramebuffer = false;
+        bool srgbFramebuffer = false;
+        int width = 0;
+        int height = 0;
+
+        // Updated every frame
+        int timeLocation = -1;
+        int frameCountLocation = -1;
+        int opacityLocation = -1;
+        float lastOpacity = -1.0f;
+
+        // Set once per build or resize
+        int resolutionLocation = -1;
+        int samplerLocation = -1;
+        int sourceSizeLocation = -1;
+        int outputSizeLocation = -1;
+        std::vector<int> lookupLocations;  // Sampler per lookup texture, -1 if unused
+    };
+
+    struct LookupTexture {
+        std::string name;
+        uint64_t contentHash = 0;     // Pixels, size and filter
+        uint32_t texture = 0;
+    };
+
+    static constexpr size_t kMaxCachedPrograms = 8;
+    // Unit 0 is the pass input; backends track 8 units
+    static constexpr size_t kMaxLookupTextures = 7;
+
+    bool createProgram(const std::string& fragmentSource, PassBinding& pass);
+    void cacheProgram(const PassBinding& pass);
+    bool takeCachedProgram(uint64_t sourceHash, PassBinding& pass);
+    void trimProgramCache(size_t limit);
+
+    // Pass targets and spare are matched by size and filter; leftovers
+    // in spare are destroyed
+    bool createTargets(std::vector<RenderTarget>& spare, BuildStats& stats);
+    void destroyTargets();
+    bool updateLookupTextures(const SlangPreset& preset, const std::vector<LookupImage>& images,
+                              BuildStats& stats);
+    void destroyLookupTextures();
+    void applyStaticUniforms();
+    static bool samePass(const PassBinding& pass, const SlangShader& shader, uint64_t sourceHash);
+    static int scaledSize(ScaleType type, float scale, int previous, int viewport);
+
+    std::unique_ptr<RenderBackend> backend_;
+    std::vector<PassBinding> passes_;
+    std::vector<PassBinding> programCache_;  // Oldest first; targets unused
+    std::vector<LookupTexture> lookups_;      // Bound to unit index + 1
+    uint32_t quad_ = 0;
+    int viewportWidth_ = 0;
+    int viewportHeight_ = 0;
+
+    uint64_t frameCount_ = 0;
+    double totalCpuMs_ = 0.0;
+    FrameStats lastFrame_;
+    BuildStats lastBuild_;
+};
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "gles_backend.h"
+#include "native_log.h"
+#include <GLES2/gl2.h>
+#include <vector>
+
+#define LOG_TAG "GlesBackend"
+
+namespace Shaderlay {
+
+namespace {
+
+// Interleaved position (xyz) and texture coordinate (uv) for a
+// full-screen triangle strip, GL texture origin at the bottom left
+const GLfloat kQuadVertices[] = {
+    -1.0f, -1.0f, 0.0f,  0.0f, 0.0f,
+     1.0f, -1.0f, 0.0f,  1.0f, 0.0f,
+    -1.0f,  1.0f, 0.0f,  0.0f, 1.0f,
+     1.0f,  1.0f, 0.0f,  1.0f, 1.0f,
+};
+
+constexpr GLsizei kQuadStride = 5 * sizeof(GLfloat);
+
+} // namespace
+
+GlesBackend::GlesBackend() = default;
+
+GlesBackend::~GlesBackend() = default;
+
+uint32_t GlesBackend::compileShader(unsigned type, const std::string& source) {
+    GLuint shader = glCreateShader(type);
+    if (shader == 0) {
+        LOGE("glCreateShader failed");
+        return 0;
+    }
+
+    const char* text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(static_cast<size_t>(length > 1 ? length : 1));
+        glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        LOGE("Shader compile failed: %s", log.data());
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+uint32_t GlesBackend::createProgram(const std::string& vertexSource, const std::string& fragmentSource) {
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (vertex == 0 || fragment == 0) {
+        if (vertex) glDeleteShader(vertex);
+        if (fragment) glDeleteShader(fragment);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glBindAttribLocation(program, kPositionAttribute, "a_Position");
+    glBindAttribLocation(program, kTexCoordAttribute, "a_TexCoord");
+    glLinkProgram(program);
+
+    // The program keeps the compiled stages alive
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(static_cast<size_t>(length > 1 ? length : 1));
+        glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        LOGE("Program link failed: %s", log.data());
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void GlesBackend::destroyProgram(uint32_t program) {
+    if (boundProgram_.matches(program)) boundProgram_.invalidate();
+    glDeleteProgram(program);
+}
+
+int GlesBackend::uniformLocation(uint32_t program, const char* name) {
+    return glGetUniformLocation(program, name);
+}
+
+bool GlesBackend::createRenderTarget(int width, int height, bool filterLinear, RenderTarget& target) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLint filter = filterLinear ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    // Setup calls above bypass the cache
+    beginFrame();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOGE("Framebuffer %dx%d incomplete: 0x%x", width, height, status);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &texture);
+        return false;
+    }
+
+    target.framebuffer = framebuffer;
+    target.texture = texture;
+    target.width = width;
+    target.height = height;
+    target.filterLinear = filterLinear;
+    return true;
+}
+
+void GlesBackend::destroyRenderTarget(const RenderTarget& target) {
+    GLuint framebuffer = target.framebuffer;
+    GLuint texture = target.texture;
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &texture);
+    beginFrame();
+}
+
+uint32_t GlesBackend::createQuad() {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(kQuadVertices), kQuadVertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return buffer;
+}
+
+void GlesBackend::destroyQuad(uint32_t quad) {
+    GLuint buffer = quad;
+    glDeleteBuffers(1, &buffer);
+}
+
+uint32_t GlesBackend::createTexture(int width, int height, const uint8_t* pixels, bool filterLinear) {
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (width <= 0 || height <= 0 || width > maxSize || height > maxSize || pixels == nullptr) {
+        LOGE("Texture %dx%d exceeds the %d limit", width, height, maxSize);
+        return 0;
+    }
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    GLint filter = filterLinear ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Setup calls above bypass the cache
+    beginFrame();
+    return texture;
+}
+
+void GlesBackend::destroyTexture(uint32_t texture) {
+    GLuint name = texture;
+    glDeleteTextures(1, &name);
+    beginFrame();
+}
+
+void GlesBackend::beginFrame() {
+    // Other code shares the context between frames; trust nothing
+    boundProgram_.invalidate();
+    boundFramebuffer_.invalidate();
+    for (auto& texture : boundTextures_) {
+        texture.invalidate();
+    }
+    activeUnit_.invalidate();
+    viewport_.invalidate();
+    blending_.invalidate();
+}
+
+void GlesBackend::bindFramebuffer(uint32_t framebuffer, int width, int height) {
+    if (!boundFramebuffer_.matches(framebuffer)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        boundFramebuffer_.set(framebuffer);
+    }
+    if (!viewport_.matches({width, height})) {
+        glViewport(0, 0, width, height);
+        viewport_.set({width, height});
+    }
+}
+
+void GlesBackend::setBlending(bool enabled) {
+    if (blending_.matches(enabled)) {
+        return;
+    }
+
+    if (enabled) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    blending_.set(enabled);
+}
+
+void GlesBackend::useProgram(uint32_t program) {
+    if (!boundProgram_.matches(program)) {
+        glUseProgram(program);
+        boundProgram_.set(program);
+    }
+}
+
+void GlesBackend::bindTexture(int unit, uint32_t texture) {
+    if (unit < 0 || unit >= kMaxTextureUnits || boundTextures_[unit].matches(texture)) {
+        return;
+    }
+
+    if (!activeUnit_.matches(unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit_.set(unit);
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    boundTextures_[unit].set(texture);
+}
+
+void GlesBackend::bindQuad(uint32_t quad) {
+    glBindBuffer(GL_ARRAY_BUFFER, quad);
+    glEnableVertexAttribArray(kPositionAttribute);
+    glVertexAttribPointer(kPositionAttribute, 3, GL_FLOAT, GL_FALSE, kQuadStride, nullptr);
+    glEnableVertexAttribArray(kTexCoordAttribute);
+    glVertexAttribPointer(kTexCoordAttribute, 2, GL_FLOAT, GL_FALSE, kQuadStride,
+                          reinterpret_cast<const void*>(3 * sizeof(GLfloat)));
+}
+
+void GlesBackend::setUniform1i(int location, int value) {
+    glUniform1i(location, value);
+}
+
+void GlesBackend::setUniform1f(int location, float value) {
+    glUniform1f(location, value);
+}
+
+void GlesBackend::setUniform2f(int location, float x, float y) {
+    glUniform2f(location, x, y);
+}
+
+void GlesBackend::setUniform4f(int location, float x, float y, float z, float w) {
+    glUniform4f(location, x, y, z, w);
+}
+
+void GlesBackend::setUniformMatrix4(int location, const float* matrix) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, matrix);
+}
+
+void GlesBackend::clear() {
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void GlesBackend::drawQuad() {
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+void GlesBackend::endFrame() {
+    // Leave the shared array buffer unbound for client-side arrays in Kotlin
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableVertexAttribArray(kPositionAttribute);
+    glDisableVertexAttribArray(kTexCoordAttribute);
+}
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "render_backend.h"
+
+namespace Shaderlay {
+
+// OpenGL ES 2.0 backend. Must be used on the thread that owns the GL
+// context. Bound program, textures, framebuffer and blend state are
+// tracked within a frame so redundant calls never reach the driver.
+class GlesBackend : public RenderBackend {
+public:
+    GlesBackend();
+    ~GlesBackend() override;
+
+    uint32_t createProgram(const std::string& vertexSource, const std::string& fragmentSource) override;
+    void destroyProgram(uint32_t program) override;
+    int uniformLocation(uint32_t program, const char* name) override;
+    bool createRenderTarget(int width, int height, bool filterLinear, RenderTarget& target) override;
+    void destroyRenderTarget(const RenderTarget& target) override;
+    uint32_t createQuad() override;
+    void destroyQuad(uint32_t quad) override;
+    uint32_t createTexture(int width, int height, const uint8_t* pixels, bool filterLinear) override;
+    void destroyTexture(uint32_t texture) override;
+
+    void beginFrame() override;
+    void bindFramebuffer(uint32_t framebuffer, int width, int height) override;
+    void setBlending(bool enabled) override;
+    void useProgram(uint32_t program) override;
+    void bindTexture(int unit, uint32_t texture) override;
+    void bindQuad(uint32_t quad) override;
+    void setUniform1i(int location, int value) override;
+    void setUniform1f(int location, float value) override;
+    void setUniform2f(int location, float x, float y) override;
+    void setUniform4f(int location, float x, float y, float z, float w) override;
+    void setUniformMatrix4(int location, const float* matrix) override;
+    void clear() override;
+    void drawQuad() override;
+    void endFrame() override;
+
+private:
+    static constexpr int kMaxTextureUnits = 8;
+
+    uint32_t compileShader(unsigned type, const std::string& source);
+
+    // State cache; beginFrame() makes every entry unknown again
+    CachedState<uint32_t> boundProgram_;
+    CachedState<uint32_t> boundFramebuffer_;
+    CachedState<uint32_t> boundTextures_[kMaxTextureUnits];
+    CachedState<int> activeUnit_;
+    CachedState<std::pair<int, int>> viewport_;
+    CachedState<bool> blending_;
+};
+
+} // namespace Shaderlay
\ No newline at end of file
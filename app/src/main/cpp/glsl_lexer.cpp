@@ -0,0 +1,256 @@
+#include "glsl_lexer.h"
+#include <algorithm>
+#include <cctype>
+
+namespace Shaderlay {
+
+namespace {
+
+constexpr int kMaxMacroDepth = 8;
+
+// Two-character operators matter for telling assignments from comparisons
+const char* const kOperators[] = {
+    "+=", "-=", "*=", "/=", "++", "--", "<=", ">=", "==", "!=", "&&", "||"
+};
+
+void blank(ArenaString& text, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        if (text[i] != '\n') text[i] = ' ';
+    }
+}
+
+// active holds the macros being expanded, innermost last; it is at most
+// kMaxMacroDepth long, so a linear search beats a set
+void expand(const GlslTokenList& input, const GlslMacroTable& macros,
+            ArenaVector<std::string_view>& active, int depth, GlslTokenList& output, size_t usePos,
+            bool keepPositions) {
+    for (size_t i = 0; i < input.size(); ++i) {
+        const GlslToken& token = input[i];
+        size_t pos = keepPositions ? token.pos : usePos;
+
+        auto macro = (token.kind == GlslTokenKind::Identifier && depth < kMaxMacroDepth)
+            ? macros.find(token.text) : macros.end();
+        if (macro == macros.end() || std::find(active.begin(), active.end(), token.text) != active.end()) {
+            output.push_back({token.kind, token.text, pos});
+            continue;
+        }
+
+        GlslTokenList replacement;
+        if (macro->second.functionLike) {
+            if (i + 1 >= input.size() || input[i + 1].text != "(") {
+                output.push_back({token.kind, token.text, pos});
+                continue;
+            }
+
+            // Collect arguments split at top-level commas
+            ArenaVector<GlslTokenList> args(1);
+            int nesting = 0;
+            size_t j = i + 2;
+            for (; j < input.size(); ++j) {
+                const ArenaString& text = input[j].text;
+                if (text == "(") nesting++;
+                if (text == ")" && nesting-- == 0) break;
+                if (text == "," && nesting == 0) {
+                    args.emplace_back();
+                } else {
+                    args.back().push_back(input[j]);
+                }
+            }
+
+            const auto& params = macro->second.params;
+            for (const auto& bodyToken : macro->second.body) {
+                auto param = std::find(params.begin(), params.end(), bodyToken.text);
+                size_t argIndex = static_cast<size_t>(param - params.begin());
+                if (param != params.end() && argIndex < args.size()) {
+                    replacement.insert(replacement.end(), args[argIndex].begin(), args[argIndex].end());
+                } else {
+                    replacement.push_back(bodyToken);
+                }
+            }
+            i = j;
+        } else {
+            replacement = macro->second.body;
+        }
+
+        active.push_back(token.text);
+        expand(replacement, macros, active, depth + 1, output, pos, false);
+        active.pop_back();
+    }
+}
+
+} // namespace
+
+namespace GlslLexer {
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+ArenaString fragmentStage(std::string_view source) {
+    size_t fragment = source.find("#pragma stage fragment");
+    if (fragment == std::string_view::npos) {
+        return ArenaString(source);
+    }
+    size_t firstStage = source.find("#pragma stage");
+    ArenaString result(source.substr(0, firstStage));
+    result += source.substr(fragment);
+    return result;
+}
+
+ArenaString stripDirectives(std::string_view source, GlslDirectiveList* directives) {
+    ArenaString text(source);
+
+    size_t i = 0;
+    while (i < text.length()) {
+        if (text.compare(i, 2, "//") == 0) {
+            size_t end = text.find('\n', i);
+            if (end == std::string::npos) end = text.length();
+            blank(text, i, end);
+            i = end;
+        } else if (text.compare(i, 2, "/*") == 0) {
+            size_t close = text.find("*/", i + 2);
+            size_t end = (close == std::string::npos) ? text.length() : close + 2;
+            blank(text, i, end);
+            i = end;
+        } else {
+            i++;
+        }
+    }
+
+    size_t lineStart = 0;
+    while (lineStart < text.length()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = text.length();
+
+        size_t hash = text.find_first_not_of(" \t\r", lineStart);
+        if (hash >= lineEnd || text[hash] != '#') {
+            lineStart = lineEnd + 1;
+            continue;
+        }
+
+        // Join continuation lines
+        ArenaString directive;
+        size_t end = lineEnd;
+        size_t from = hash + 1;
+        for (;;) {
+            size_t last = text.find_last_not_of(" \t\r", end == 0 ? 0 : end - 1);
+            bool continued = last != std::string::npos && last >= from && text[last] == '\\' &&
+                             end < text.length();
+            directive.append(text, from, (continued ? last : end) - from);
+            if (!continued) break;
+
+            from = end + 1;
+            end = text.find('\n', from);
+            if (end == std::string::npos) end = text.length();
+        }
+
+        if (directives) {
+            size_t nameStart = directive.find_first_not_of(" \t");
+            if (nameStart == std::string::npos) nameStart = directive.length();
+            directives->emplace_back(directive, nameStart);
+        }
+        blank(text, hash, end);
+        lineStart = end + 1;
+    }
+
+    return text;
+}
+
+GlslTokenList tokenize(std::string_view text) {
+    return tokenize(text, 0, text.length());
+}
+
+GlslTokenList tokenize(std::string_view text, size_t begin, size_t end) {
+    GlslTokenList tokens;
+    end = std::min(end, text.length());
+    size_t i = begin;
+
+    while (i < end) {
+        char c = text[i];
+
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            i++;
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = i;
+            while (i < end && isIdentifierChar(text[i])) i++;
+            tokens.push_back({GlslTokenKind::Identifier, ArenaString(text.substr(start, i - start)), start});
+        } else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                   (c == '.' && i + 1 < end && std::isdigit(static_cast<unsigned char>(text[i + 1])))) {
+            // Includes exponents and suffixes such as 1.0e-5 or 2u
+            size_t start = i;
+            bool hex = text.compare(i, 2, "0x") == 0 || text.compare(i, 2, "0X") == 0;
+            while (i < end &&
+                   (isIdentifierChar(text[i]) || text[i] == '.' ||
+                    (!hex && (text[i] == '-' || text[i] == '+') &&
+                     (text[i - 1] == 'e' || text[i - 1] == 'E')))) {
+                i++;
+            }
+            tokens.push_back({GlslTokenKind::Number, ArenaString(text.substr(start, i - start)), start});
+        } else {
+            std::string_view symbol = text.substr(i, 1);
+            if (i + 1 < end) {
+                for (const char* op : kOperators) {
+                    if (text.compare(i, 2, op) == 0) {
+                        symbol = op;
+                        break;
+                    }
+                }
+            }
+            tokens.push_back({GlslTokenKind::Symbol, ArenaString(symbol), i});
+            i += symbol.length();
+        }
+    }
+
+    return tokens;
+}
+
+void parseDefine(std::string_view directive, GlslMacroTable& macros) {
+    if (directive.compare(0, 6, "define") != 0) return;
+
+    size_t nameStart = directive.find_first_not_of(" \t", 6);
+    if (nameStart == std::string::npos || nameStart == 6) return;
+
+    size_t nameEnd = nameStart;
+    while (nameEnd < directive.length() && isIdentifierChar(directive[nameEnd])) nameEnd++;
+    if (nameEnd == nameStart) return;
+
+    GlslMacro macro;
+    size_t bodyStart = nameEnd;
+    if (nameEnd < directive.length() && directive[nameEnd] == '(') {
+        size_t close = directive.find(')', nameEnd);
+        if (close == std::string::npos) return;
+
+        macro.functionLike = true;
+        for (const auto& token : tokenize(directive, nameEnd + 1, close)) {
+            if (token.kind == GlslTokenKind::Identifier) macro.params.push_back(token.text);
+        }
+        bodyStart = close + 1;
+    }
+
+    macro.body = tokenize(directive, bodyStart, directive.length());
+    macros[ArenaString(directive.substr(nameStart, nameEnd - nameStart))] = std::move(macro);
+}
+
+GlslMacroTable collectMacros(const GlslDirectiveList& directives) {
+    GlslMacroTable macros;
+    for (const auto& directive : directives) {
+        parseDefine(directive, macros);
+    }
+    return macros;
+}
+
+GlslTokenList expandMacros(const GlslTokenList& tokens, const GlslMacroTable& macros) {
+    if (macros.empty()) {
+        return tokens;
+    }
+
+    GlslTokenList output;
+    output.reserve(tokens.size());
+    ArenaVector<std::string_view> active;
+    expand(tokens, macros, active, 0, output, 0, true);
+    return output;
+}
+
+} // namespace GlslLexer
+
+} // namespace Shaderlay
\ No newline at end of file
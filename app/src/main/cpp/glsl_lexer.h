@@ -0,0 +1,65 @@
+#pragma once
+
+#include "compile_arena.h"
+#include <string_view>
+
+namespace Shaderlay {
+
+enum class GlslTokenKind {
+    Identifier,
+    Number,
+    Symbol
+};
+
+struct GlslToken {
+    GlslTokenKind kind;
+    ArenaString text;
+    size_t pos;        // Offset in the lexed text; macro expansions take the macro name's
+};
+
+using GlslTokenList = ArenaVector<GlslToken>;
+
+struct GlslMacro {
+    bool functionLike = false;
+    ArenaVector<ArenaString> params;
+    GlslTokenList body;
+};
+
+using GlslMacroTable = ArenaMap<ArenaString, GlslMacro>;
+using GlslDirectiveList = ArenaVector<ArenaString>;
+
+// Front end shared by the static shader analyzers (precision, render
+// dependency, cost). Not a full preprocessor: conditionals are not
+// evaluated, so code from every branch is kept. Results are arena
+// containers, so an analyzer running inside an ArenaScope keeps all of
+// its scratch state off the heap.
+namespace GlslLexer {
+
+bool isIdentifierChar(char c);
+
+// For a .slang file, the shared prologue followed by the fragment stage;
+// other sources are returned unchanged
+ArenaString fragmentStage(std::string_view source);
+
+// Blanks comments and preprocessor lines (with their continuations) in
+// place. Newlines are kept, so offsets map one-to-one onto source. Each
+// directive is appended to directives, if given, without the '#' and
+// with continuations joined, e.g. "define SCALE 2.0".
+ArenaString stripDirectives(std::string_view source, GlslDirectiveList* directives);
+
+GlslTokenList tokenize(std::string_view text);
+GlslTokenList tokenize(std::string_view text, size_t begin, size_t end);
+
+// Adds the macro from a "define NAME(a, b) body" or "define NAME body"
+// directive; other directives are ignored
+void parseDefine(std::string_view directive, GlslMacroTable& macros);
+
+GlslMacroTable collectMacros(const GlslDirectiveList& directives);
+
+// Expands object-like and function-like macros, including macros used
+// in their replacements. Self-references are left unexpanded.
+GlslTokenList expandMacros(const GlslTokenList& tokens, const GlslMacroTable& macros);
+
+} // namespace GlslLexer
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,607 @@
+#include "gpu_cost_estimator.h"
+#include "glsl_lexer.h"
+#include "native_log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <string_view>
+
+#define LOG_TAG "GpuCostEstimator"
+
+namespace Shaderlay {
+
+namespace {
+
+// A fetch costs several ALU ops of latency and bandwidth; every pixel
+// also pays for its framebuffer write
+constexpr double kFetchWeight = 4.0;
+constexpr double kPixelWriteWeight = 2.0;
+
+// Parameter defaults and const scalars by name
+using ConstantTable = ArenaMap<ArenaString, double>;
+
+// Used when a loop bound depends on runtime values
+constexpr double kDefaultLoopTrips = 8.0;
+constexpr double kMaxLoopTrips = 1024.0;
+
+// Sustained cost units per millisecond, matched as substrings of
+// GL_RENDERER in order. Deliberately conservative: the overlay shares
+// the GPU with whatever is running underneath.
+struct DeviceCalibration {
+    const char* renderer;
+    double unitsPerMs;
+};
+
+constexpr DeviceCalibration kCalibration[] = {
+    {"Adreno (TM) 7", 1.0e9},
+    {"Adreno (TM) 6", 4.0e8},
+    {"Adreno (TM) 5", 1.5e8},
+    {"Immortalis", 1.0e9},
+    {"Mali-G7", 5.0e8},
+    {"Mali-G6", 3.0e8},
+    {"Mali-G5", 1.5e8},
+    {"Mali-G3", 5.0e7},
+    {"Mali-T", 5.0e7},
+    {"Xclipse", 8.0e8},
+    {"PowerVR", 1.0e8},
+};
+constexpr double kDefaultUnitsPerMs = 1.5e8;
+
+struct Cost {
+    double fetches = 0.0;
+    double alu = 0.0;
+    double iterations = 0.0;
+
+    Cost& operator+=(const Cost& other) {
+        fetches += other.fetches;
+        alu += other.alu;
+        iterations += other.iterations;
+        return *this;
+    }
+
+    Cost scaled(double factor) const {
+        Cost result;
+        result.fetches = fetches * factor;
+        result.alu = alu * factor;
+        result.iterations = iterations * factor;
+        return result;
+    }
+};
+
+bool isSamplingFunction(std::string_view name) {
+    return name == "texture" || name == "texture2D" || name == "texture2DProj" ||
+           name == "texture2DLod" || name == "textureLod" || name == "texelFetch" ||
+           name == "textureCube" || name == "textureGrad" || name == "textureOffset";
+}
+
+double builtinWeight(std::string_view name) {
+    static const std::map<std::string, double, std::less<>> weights = {
+        {"sin", 4.0}, {"cos", 4.0}, {"tan", 4.0}, {"asin", 4.0}, {"acos", 4.0}, {"atan", 4.0},
+        {"pow", 4.0}, {"exp", 4.0}, {"log", 4.0}, {"exp2", 4.0}, {"log2", 4.0},
+        {"sqrt", 4.0}, {"inversesqrt", 4.0},
+        {"normalize", 3.0}, {"length", 3.0}, {"distance", 3.0}, {"smoothstep", 3.0},
+        {"dot", 2.0}, {"cross", 2.0}, {"reflect", 2.0}, {"refract", 2.0}, {"mix", 2.0},
+        {"clamp", 1.0}, {"min", 1.0}, {"max", 1.0}, {"abs", 1.0}, {"sign", 1.0},
+        {"floor", 1.0}, {"ceil", 1.0}, {"fract", 1.0}, {"mod", 1.0}, {"step", 1.0},
+    };
+
+    auto it = weights.find(name);
+    return it != weights.end() ? it->second : 0.0;
+}
+
+bool isArithmetic(std::string_view symbol) {
+    return symbol == "+" || symbol == "-" || symbol == "*" || symbol == "/" ||
+           symbol == "+=" || symbol == "-=" || symbol == "*=" || symbol == "/=" ||
+           symbol == "++" || symbol == "--";
+}
+
+bool isComparison(std::string_view symbol) {
+    return symbol == "<" || symbol == "<=" || symbol == ">" || symbol == ">=" || symbol == "!=";
+}
+
+// "pragma parameter NAME "Label" default min max step"
+void parseParameter(std::string_view directive, ConstantTable& constants) {
+    GlslTokenList tokens =
+        GlslLexer::tokenize(directive, directive.find("parameter") + 9, directive.length());
+    if (tokens.empty() || tokens[0].kind != GlslTokenKind::Identifier) return;
+
+    size_t closeQuote = directive.rfind('"');
+    if (closeQuote == std::string_view::npos) return;
+
+    GlslTokenList values = GlslLexer::tokenize(directive, closeQuote + 1, directive.length());
+    bool negative = false;
+    for (const auto& token : values) {
+        if (token.text == "-") {
+            negative = true;
+        } else if (token.kind == GlslTokenKind::Number) {
+            double value = std::strtod(token.text.c_str(), nullptr);
+            constants[tokens[0].text] = negative ? -value : value;
+            return;
+        } else {
+            return;
+        }
+    }
+}
+
+// Evaluates constant expressions over parameters and const declarations,
+// e.g. "-SIZEV" after expansion to "- params . SIZEV"
+class ConstantEvaluator {
+public:
+    ConstantEvaluator(const GlslTokenList& tokens, const ConstantTable& constants)
+        : tokens_(tokens), constants_(constants) {}
+
+    bool evaluate(size_t begin, size_t end, double& value) {
+        pos_ = begin;
+        end_ = end;
+        return begin < end && parseSum(value) && pos_ == end_;
+    }
+
+private:
+    bool peek(const char* text) const {
+        return pos_ < end_ && tokens_[pos_].text == text;
+    }
+
+    bool parseSum(double& value) {
+        if (!parseProduct(value)) return false;
+        while (peek("+") || peek("-")) {
+            bool add = tokens_[pos_++].text == "+";
+            double rhs = 0.0;
+            if (!parseProduct(rhs)) return false;
+            value = add ? value + rhs : value - rhs;
+        }
+        return true;
+    }
+
+    bool parseProduct(double& value) {
+        if (!parseUnary(value)) return false;
+        while (peek("*") || peek("/")) {
+            bool multiply = tokens_[pos_++].text == "*";
+            double rhs = 0.0;
+            if (!parseUnary(rhs)) return false;
+            if (!multiply && rhs == 0.0) return false;
+            value = multiply ? value * rhs : value / rhs;
+        }
+        return true;
+    }
+
+    bool parseUnary(double& value) {
+        if (peek("-") || peek("+")) {
+            bool negate = tokens_[pos_++].text == "-";
+            if (!parseUnary(value)) return false;
+            if (negate) value = -value;
+            return true;
+        }
+        return parsePrimary(value);
+    }
+
+    bool parsePrimary(double& value) {
+        if (pos_ >= end_) return false;
+        const GlslToken& token = tokens_[pos_];
+
+        if (token.kind == GlslTokenKind::Number) {
+            value = std::strtod(token.text.c_str(), nullptr);
+            pos_++;
+            return true;
+        }
+
+        if (token.text == "(" || (token.kind == GlslTokenKind::Identifier && pos_ + 1 < end_ &&
+                                  tokens_[pos_ + 1].text == "(" &&
+                                  (token.text == "float" || token.text == "int" || token.text == "uint"))) {
+            // Parenthesised expression or scalar cast
+            pos_ += (token.text == "(") ? 1 : 2;
+            if (!parseSum(value) || !peek(")")) return false;
+            pos_++;
+            return true;
+        }
+
+        if (token.kind == GlslTokenKind::Identifier) {
+            // params.NAME and global.NAME resolve to the parameter default
+            std::string_view name = token.text;
+            pos_++;
+            if (peek(".") && pos_ + 1 < end_ && tokens_[pos_ + 1].kind == GlslTokenKind::Identifier) {
+                name = tokens_[pos_ + 1].text;
+                pos_ += 2;
+            }
+
+            auto constant = constants_.find(name);
+            if (constant == constants_.end()) return false;
+            value = constant->second;
+            return true;
+        }
+        return false;
+    }
+
+    const GlslTokenList& tokens_;
+    const ConstantTable& constants_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+};
+
+// Walks function bodies, inlining calls to earlier functions and
+// multiplying loop bodies by their estimated trip counts
+class CostWalker {
+public:
+    CostWalker(const GlslTokenList& tokens, const ConstantTable& constants)
+        : tokens_(tokens), constants_(constants), evaluator_(tokens, constants) {}
+
+    Cost run() {
+        size_t i = 0;
+        while (i < tokens_.size()) {
+            const GlslToken& token = tokens_[i];
+            if (token.text == "{") {
+                i = matching(i) + 1;
+                continue;
+            }
+
+            if (token.kind == GlslTokenKind::Identifier && i + 1 < tokens_.size() && tokens_[i + 1].text == "(") {
+                size_t close = matching(i + 1);
+                if (close + 1 < tokens_.size() && tokens_[close + 1].text == "{") {
+                    size_t bodyEnd = matching(close + 1);
+                    functions_[token.text] = rangeCost(close + 2, bodyEnd, close + 2);
+                    i = bodyEnd + 1;
+                    continue;
+                }
+                i = close + 1;
+                continue;
+            }
+            i++;
+        }
+
+        auto main = functions_.find("main");
+        return main != functions_.end() ? main->second : Cost{};
+    }
+
+private:
+    // Index of the bracket closing the one at open, or the last token
+    size_t matching(size_t open) const {
+        const ArenaString& opener = tokens_[open].text;
+        const char* closer = (opener == "(") ? ")" : (opener == "[") ? "]" : "}";
+        int depth = 0;
+        for (size_t i = open; i < tokens_.size(); ++i) {
+            if (tokens_[i].text == opener) depth++;
+            else if (tokens_[i].text == closer && --depth == 0) return i;
+        }
+        return tokens_.size() - 1;
+    }
+
+    // End (exclusive) of the statement or block starting at begin
+    size_t statementEnd(size_t begin, size_t end) const {
+        if (begin >= end) return end;
+        if (tokens_[begin].text == "{") return std::min(matching(begin) + 1, end);
+
+        for (size_t i = begin; i < end; ++i) {
+            const ArenaString& text = tokens_[i].text;
+            if (text == "(" || text == "[" || text == "{") {
+                i = matching(i);
+            } else if (text == ";") {
+                return i + 1;
+            }
+        }
+        return end;
+    }
+
+    Cost rangeCost(size_t begin, size_t end, size_t functionStart) {
+        Cost cost;
+        size_t i = begin;
+
+        while (i < end) {
+            const GlslToken& token = tokens_[i];
+            bool call = token.kind == GlslTokenKind::Identifier && i + 1 < end && tokens_[i + 1].text == "(";
+
+            if (call && token.text == "for") {
+                size_t close = matching(i + 1);
+                size_t bodyEnd = statementEnd(close + 1, end);
+                double trips = forTrips(i + 2, close);
+
+                Cost iteration = rangeCost(close + 1, bodyEnd, functionStart);
+                iteration += rangeCost(i + 2, close, functionStart);
+                cost += iteration.scaled(trips);
+                cost.iterations += trips;
+                i = bodyEnd;
+                continue;
+            }
+
+            if (call && token.text == "while") {
+                size_t close = matching(i + 1);
+                size_t bodyEnd = statementEnd(close + 1, end);
+                double trips = conditionTrips(i + 2, close, functionStart, i, close + 1, bodyEnd);
+
+                Cost iteration = rangeCost(close + 1, bodyEnd, functionStart);
+                iteration += rangeCost(i + 2, close, functionStart);
+                cost += iteration.scaled(trips);
+                cost.iterations += trips;
+                i = bodyEnd;
+                continue;
+            }
+
+            if (token.text == "do") {
+                size_t bodyEnd = statementEnd(i + 1, end);
+                if (bodyEnd + 1 < end && tokens_[bodyEnd].text == "while" && tokens_[bodyEnd + 1].text == "(") {
+                    size_t close = matching(bodyEnd + 1);
+                    double trips = conditionTrips(bodyEnd + 2, close, functionStart, i, i + 1, bodyEnd);
+
+                    Cost iteration = rangeCost(i + 1, bodyEnd, functionStart);
+                    iteration += rangeCost(bodyEnd + 2, close, functionStart);
+                    cost += iteration.scaled(trips);
+                    cost.iterations += trips;
+                    i = statementEnd(close + 1, end);
+                    continue;
+                }
+            }
+
+            if (call) {
+                auto function = functions_.find(token.text);
+                if (isSamplingFunction(token.text)) {
+                    cost.fetches += 1.0;
+                } else if (function != functions_.end()) {
+                    cost += function->second;
+                } else {
+                    cost.alu += builtinWeight(token.text);
+                }
+            } else if (token.kind == GlslTokenKind::Symbol && isArithmetic(token.text)) {
+                cost.alu += 1.0;
+            }
+            i++;
+        }
+        return cost;
+    }
+
+    // Top-level comparison in [begin, end) as "variable op bound"
+    bool splitCondition(size_t begin, size_t end, std::string_view& variable, std::string_view& op,
+                        double& bound) {
+        for (size_t i = begin; i < end; ++i) {
+            if (tokens_[i].text == "(" || tokens_[i].text == "[") {
+                i = matching(i);
+                continue;
+            }
+            if (!isComparison(tokens_[i].text)) continue;
+
+            op = tokens_[i].text;
+            if (i == begin + 1 && tokens_[begin].kind == GlslTokenKind::Identifier) {
+                variable = tokens_[begin].text;
+                return evaluator_.evaluate(i + 1, end, bound);
+            }
+            if (i + 2 == end && tokens_[i + 1].kind == GlslTokenKind::Identifier) {
+                // "bound > i" reads as "i < bound"
+                variable = tokens_[i + 1].text;
+                if (op == "<") op = ">";
+                else if (op == ">") op = "<";
+                else if (op == "<=") op = ">=";
+                else if (op == ">=") op = "<=";
+                return evaluator_.evaluate(begin, i, bound);
+            }
+            return false;
+        }
+        return false;
+    }
+
+    // Step applied to variable within [begin, end); defaults to +1
+    double findStep(std::string_view variable, size_t begin, size_t end) {
+        for (size_t i = begin; i + 1 < end; ++i) {
+            bool before = tokens_[i].text == variable;
+            bool after = i + 2 < end && tokens_[i + 1].text == variable;
+            if ((before && tokens_[i + 1].text == "++") || (after && tokens_[i].text == "++")) return 1.0;
+            if ((before && tokens_[i + 1].text == "--") || (after && tokens_[i].text == "--")) return -1.0;
+            if (!before) continue;
+
+            const ArenaString& op = tokens_[i + 1].text;
+            size_t valueStart = i + 2;
+            size_t valueEnd = statementEnd(valueStart, end);
+            if (valueEnd > valueStart && tokens_[valueEnd - 1].text == ";") valueEnd--;
+
+            double step = 0.0;
+            if ((op == "+=" || op == "-=") && evaluator_.evaluate(valueStart, valueEnd, step)) {
+                return op == "+=" ? step : -step;
+            }
+            // "n = n + 1.0" or "n = n - k"
+            if (op == "=" && valueStart + 1 < valueEnd && tokens_[valueStart].text == variable &&
+                (tokens_[valueStart + 1].text == "+" || tokens_[valueStart + 1].text == "-") &&
+                evaluator_.evaluate(valueStart + 2, valueEnd, step)) {
+                return tokens_[valueStart + 1].text == "+" ? step : -step;
+            }
+        }
+        return 1.0;
+    }
+
+    static double tripCount(double start, double bound, std::string_view op, double step) {
+        double trips = kDefaultLoopTrips;
+        if (step > 0.0 && op == "<") {
+            trips = std::ceil((bound - start) / step);
+        } else if (step > 0.0 && op == "<=") {
+            trips = std::floor((bound - start) / step) + 1.0;
+        } else if (step < 0.0 && op == ">") {
+            trips = std::ceil((start - bound) / -step);
+        } else if (step < 0.0 && op == ">=") {
+            trips = std::floor((start - bound) / -step) + 1.0;
+        } else if (step != 0.0 && op == "!=") {
+            trips = std::fabs((bound - start) / step);
+        }
+        return std::min(std::max(trips, 1.0), kMaxLoopTrips);
+    }
+
+    // for (init; condition; step)
+    double forTrips(size_t begin, size_t end) {
+        size_t firstSemicolon = end;
+        size_t secondSemicolon = end;
+        for (size_t i = begin; i < end; ++i) {
+            if (tokens_[i].text != ";") continue;
+            if (firstSemicolon == end) firstSemicolon = i;
+            else secondSemicolon = i;
+        }
+        if (secondSemicolon == end) return kDefaultLoopTrips;
+
+        std::string_view variable;
+        std::string_view op;
+        double bound = 0.0;
+        if (!splitCondition(firstSemicolon + 1, secondSemicolon, variable, op, bound)) {
+            return kDefaultLoopTrips;
+        }
+
+        // Unknown starts (e.g. computed offsets) count from zero, which
+        // gives the upper bound for the usual "i = start; i < N" loops
+        double start = 0.0;
+        for (size_t i = begin; i + 1 < firstSemicolon; ++i) {
+            if (tokens_[i].text == variable && tokens_[i + 1].text == "=") {
+                if (!evaluator_.evaluate(i + 2, firstSemicolon, start)) start = 0.0;
+                break;
+            }
+        }
+
+        return tripCount(start, bound, op, findStep(variable, secondSemicolon + 1, end));
+    }
+
+    // while (condition) and do {} while (condition); the start value is
+    // the last assignment to the loop variable before the loop
+    double conditionTrips(size_t begin, size_t end, size_t functionStart, size_t loopStart,
+                          size_t bodyBegin, size_t bodyEnd) {
+        std::string_view variable;
+        std::string_view op;
+        double bound = 0.0;
+        if (!splitCondition(begin, end, variable, op, bound)) {
+            return kDefaultLoopTrips;
+        }
+
+        bool found = false;
+        double start = 0.0;
+        for (size_t i = functionStart; i + 1 < loopStart; ++i) {
+            if (tokens_[i].text != variable || tokens_[i + 1].text != "=") continue;
+
+            size_t valueEnd = statementEnd(i + 2, loopStart);
+            if (valueEnd > i + 2 && tokens_[valueEnd - 1].text == ";") valueEnd--;
+            found = evaluator_.evaluate(i + 2, valueEnd, start);
+        }
+        if (!found) {
+            return kDefaultLoopTrips;
+        }
+
+        return tripCount(start, bound, op, findStep(variable, bodyBegin, bodyEnd));
+    }
+
+    const GlslTokenList& tokens_;
+    const ConstantTable& constants_;
+    ConstantEvaluator evaluator_;
+    ArenaMap<ArenaString, Cost> functions_;
+};
+
+double scaledSize(ScaleType type, float scale, double previous, int viewport) {
+    switch (type) {
+        case ScaleType::Viewport:
+            return viewport * scale;
+        case ScaleType::Absolute:
+            return scale;
+        case ScaleType::Source:
+        default:
+            return previous * scale;
+    }
+}
+
+} // namespace
+
+GpuCostEstimator::GpuCostEstimator() = default;
+
+GpuCostEstimator::~GpuCostEstimator() = default;
+
+PassCost GpuCostEstimator::analyzePass(const std::string& passSource) {
+    // .slang files carry both stages; only the fragment stage is costed.
+    // Directives feed the macro and constant tables; everything else is code.
+    GlslDirectiveList directives;
+    ArenaString code = GlslLexer::stripDirectives(GlslLexer::fragmentStage(passSource), &directives);
+
+    GlslMacroTable macros = GlslLexer::collectMacros(directives);
+    ConstantTable constants;
+    for (const auto& directive : directives) {
+        if (directive.compare(0, 6, "pragma") == 0 && directive.find("parameter") != ArenaString::npos) {
+            parseParameter(directive, constants);
+        }
+    }
+
+    GlslTokenList tokens = GlslLexer::expandMacros(GlslLexer::tokenize(code), macros);
+
+    // Scalar constants such as "const int TAPS = 8;" can bound loops
+    ConstantEvaluator evaluator(tokens, constants);
+    for (size_t i = 0; i + 4 < tokens.size(); ++i) {
+        if (tokens[i].text != "const" || tokens[i + 3].text != "=") continue;
+
+        size_t end = i + 4;
+        while (end < tokens.size() && tokens[end].text != ";") end++;
+
+        double value = 0.0;
+        if (evaluator.evaluate(i + 4, end, value)) {
+            constants[tokens[i + 2].text] = value;
+        }
+    }
+
+    Cost cost = CostWalker(tokens, constants).run();
+
+    PassCost result;
+    result.textureFetches = cost.fetches;
+    result.aluOps = cost.alu;
+    result.loopIterations = cost.iterations;
+    result.pixelCost = cost.alu + cost.fetches * kFetchWeight + kPixelWriteWeight;
+    return result;
+}
+
+PresetCost GpuCostEstimator::estimatePreset(const SlangPreset& preset,
+                                            const std::vector<std::string>& passSources,
+                                            int sourceWidth, int sourceHeight,
+                                            int viewportWidth, int viewportHeight) {
+    PresetCost result;
+    double width = sourceWidth;
+    double height = sourceHeight;
+
+    for (size_t i = 0; i < preset.shaders.size(); ++i) {
+        const SlangShader& shader = preset.shaders[i];
+        if (i >= passSources.size()) {
+            LOGW("No source for pass %zu, counting it as empty", i);
+        }
+
+        PassCost pass = analyzePass(i < passSources.size() ? passSources[i] : std::string());
+
+        width = scaledSize(shader.scaleTypeX, shader.scaleX, width, viewportWidth);
+        height = scaledSize(shader.scaleTypeY, shader.scaleY, height, viewportHeight);
+        width = std::max(1.0, std::round(width));
+        height = std::max(1.0, std::round(height));
+        pass.width = static_cast<int>(width);
+        pass.height = static_cast<int>(height);
+        pass.frameCost = pass.pixelCost * width * height;
+        result.frameCost += pass.frameCost;
+
+        LOGV("Pass %zu: %dx%d, %.1f fetches, %.1f ALU, %.0f units/pixel",
+             i, pass.width, pass.height, pass.textureFetches, pass.aluOps, pass.pixelCost);
+        result.passes.push_back(pass);
+    }
+
+    LOGD("Preset cost: %.3g units/frame over %zu passes", result.frameCost, result.passes.size());
+    return result;
+}
+
+double GpuCostEstimator::deviceThroughput(const std::string& renderer) {
+    for (const auto& entry : kCalibration) {
+        if (renderer.find(entry.renderer) != std::string::npos) {
+            return entry.unitsPerMs;
+        }
+    }
+    return kDefaultUnitsPerMs;
+}
+
+double GpuCostEstimator::estimateFrameTimeMs(double frameCost, const std::string& renderer) {
+    return frameCost / deviceThroughput(renderer);
+}
+
+int GpuCostEstimator::selectTier(const std::vector<double>& frameCosts, const std::string& renderer,
+                                 double frameBudgetMs) {
+    for (int tier = static_cast<int>(frameCosts.size()) - 1; tier >= 0; --tier) {
+        double frameTime = estimateFrameTimeMs(frameCosts[tier], renderer);
+        if (frameTime <= frameBudgetMs) {
+            LOGI("Selected tier %d (%.2f ms of %.2f ms budget) for %s",
+                 tier, frameTime, frameBudgetMs, renderer.c_str());
+            return tier;
+        }
+    }
+
+    LOGW("No tier fits the %.2f ms budget on %s", frameBudgetMs, renderer.c_str());
+    return -1;
+}
+
+} // namespace Shaderlay
\ No newline at end of file
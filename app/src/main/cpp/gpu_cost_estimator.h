@@ -0,0 +1,56 @@
+#pragma once
+
+#include "slang_parser.h"
+#include <string>
+#include <vector>
+
+namespace Shaderlay {
+
+struct PassCost {
+    // Per output pixel, with loop bodies multiplied by their trip counts
+    double textureFetches = 0.0;
+    double aluOps = 0.0;
+    double loopIterations = 0.0;
+    double pixelCost = 0.0;       // Weighted cost units per pixel
+
+    // Filled in by estimatePreset
+    int width = 0;
+    int height = 0;
+    double frameCost = 0.0;       // pixelCost * width * height
+};
+
+struct PresetCost {
+    std::vector<PassCost> passes;
+    double frameCost = 0.0;
+};
+
+// Static per-frame cost model for shader presets. Costs are abstract
+// units (one ALU op per pixel = 1); a per-GPU calibration table turns
+// them into milliseconds so the heaviest tier of a look that still fits
+// the frame budget can be chosen before anything is compiled.
+class GpuCostEstimator {
+public:
+    GpuCostEstimator();
+    ~GpuCostEstimator();
+
+    // Accepts a .slang file (fragment stage is used) or translated GLSL
+    PassCost analyzePass(const std::string& passSource);
+
+    // passSources[i] is the source of pass i; sizes follow scaleType/scale
+    // from the source size through the chain
+    PresetCost estimatePreset(const SlangPreset& preset, const std::vector<std::string>& passSources,
+                              int sourceWidth, int sourceHeight,
+                              int viewportWidth, int viewportHeight);
+
+    // Cost units per millisecond for a GL_RENDERER string
+    static double deviceThroughput(const std::string& renderer);
+    static double estimateFrameTimeMs(double frameCost, const std::string& renderer);
+
+    // frameCosts are ordered lightest to heaviest (fast, advanced, hd).
+    // Returns the heaviest index that fits the budget, or -1 if none do;
+    // callers then fall back to the lightest tier themselves.
+    static int selectTier(const std::vector<double>& frameCosts, const std::string& renderer,
+                          double frameBudgetMs);
+};
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -1,27 +1,156 @@
 #include <jni.h>
-#include <android/log.h>
+#include <algorithm>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "shader_compiler.h"
 #include "slang_parser.h"
 #include "spirv_handler.h"
+#include "shader_archive.h"
+#include "preset_index.h"
+#include "compile_scheduler.h"
+#include "gpu_cost_estimator.h"
+#include "frame_executor.h"
+#include "gles_backend.h"
+#include "recording_backend.h"
+#include "native_log.h"
 
 #define LOG_TAG "JNIInterface"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 using namespace Shaderlay;
 
 static std::unique_ptr<ShaderCompiler> g_shaderCompiler;
 static std::unique_ptr<SlangParser> g_slangParser;
 static std::unique_ptr<SPIRVHandler> g_spirvHandler;
+// Open shader packs by handle. Packs are read from whichever thread
+// resolves a preset, so each call takes its own reference to the archive
+// and a concurrent close only unmaps it once the last reader is done.
+static std::mutex g_shaderArchiveMutex;
+static std::unordered_map<jlong, std::shared_ptr<ShaderArchive>> g_shaderArchives;
+static jlong g_nextShaderArchiveHandle = 1;
+// Index of the pack last opened by the preset picker, guarded like the packs
+static std::mutex g_presetIndexMutex;
+static std::unique_ptr<PresetIndex> g_presetIndex;
+static std::string g_presetIndexPath;
+static std::unique_ptr<CompileScheduler> g_compileScheduler;
+static std::unique_ptr<FrameExecutor> g_frameExecutor;
+static bool g_frameExecutorHeadless = false;
+static JavaVM* g_javaVM = nullptr;
+
+// Attaches scheduler worker threads to the VM on first use and detaches
+// them when the thread exits
+static JNIEnv* getWorkerEnv() {
+    struct Attachment {
+        JNIEnv* env = nullptr;
+        ~Attachment() {
+            if (env && g_javaVM) {
+                g_javaVM->DetachCurrentThread();
+            }
+        }
+    };
+    thread_local Attachment attachment;
+
+    if (!attachment.env && g_javaVM) {
+        if (g_javaVM->AttachCurrentThread(&attachment.env, nullptr) != JNI_OK) {
+            LOGE("Failed to attach compile worker to JVM");
+            attachment.env = nullptr;
+        }
+    }
+    return attachment.env;
+}
+
+static std::shared_ptr<ShaderArchive> findShaderArchive(jlong handle) {
+    std::lock_guard<std::mutex> lock(g_shaderArchiveMutex);
+    auto it = g_shaderArchives.find(handle);
+    if (it == g_shaderArchives.end()) {
+        LOGE("Shader archive %lld not open", static_cast<long long>(handle));
+        return nullptr;
+    }
+    return it->second;
+}
+
+// Deletes a global reference on scope exit unless ownership was handed on
+class GlobalRefGuard {
+public:
+    GlobalRefGuard(JNIEnv* env, jobject ref) : env_(env), ref_(ref) {}
+    ~GlobalRefGuard() {
+        if (ref_) env_->DeleteGlobalRef(ref_);
+    }
+
+    GlobalRefGuard(const GlobalRefGuard&) = delete;
+    GlobalRefGuard& operator=(const GlobalRefGuard&) = delete;
+
+    jobject get() const { return ref_; }
+    void release() { ref_ = nullptr; }
+
+private:
+    JNIEnv* env_;
+    jobject ref_;
+};
+
+static std::string jstringToString(JNIEnv *env, jstring value) {
+    const char* chars = env->GetStringUTFChars(value, nullptr);
+    if (!chars) {
+        return "";
+    }
+    std::string result(chars);
+    env->ReleaseStringUTFChars(value, chars);
+    return result;
+}
+
+// Null elements become empty strings
+static std::vector<std::string> jstringArrayToVector(JNIEnv *env, jobjectArray values) {
+    std::vector<std::string> result;
+    jsize count = env->GetArrayLength(values);
+    result.reserve(static_cast<size_t>(count));
+    for (jsize i = 0; i < count; ++i) {
+        jstring value = static_cast<jstring>(env->GetObjectArrayElement(values, i));
+        result.push_back(value ? jstringToString(env, value) : std::string());
+        env->DeleteLocalRef(value);
+    }
+    return result;
+}
+
+// names[i] pairs with pixels[i] and sizes[2 * i], sizes[2 * i + 1]
+static std::vector<LookupImage> lookupImagesFromArrays(JNIEnv *env, jobjectArray names,
+                                                       jintArray sizes, jobjectArray pixels) {
+    std::vector<LookupImage> images;
+    if (!names || !sizes || !pixels) {
+        return images;
+    }
+
+    std::vector<std::string> imageNames = jstringArrayToVector(env, names);
+    jsize count = std::min(static_cast<jsize>(imageNames.size()), env->GetArrayLength(pixels));
+    count = std::min(count, env->GetArrayLength(sizes) / 2);
+    std::vector<jint> dimensions(static_cast<size_t>(count) * 2);
+    env->GetIntArrayRegion(sizes, 0, count * 2, dimensions.data());
+
+    for (jsize i = 0; i < count; ++i) {
+        jbyteArray data = static_cast<jbyteArray>(env->GetObjectArrayElement(pixels, i));
+        if (!data) {
+            continue;
+        }
+
+        LookupImage image;
+        image.name = std::move(imageNames[i]);
+        image.width = dimensions[i * 2];
+        image.height = dimensions[i * 2 + 1];
+        image.pixels.resize(static_cast<size_t>(env->GetArrayLength(data)));
+        env->GetByteArrayRegion(data, 0, static_cast<jsize>(image.pixels.size()),
+                                reinterpret_cast<jbyte*>(image.pixels.data()));
+        env->DeleteLocalRef(data);
+        images.push_back(std::move(image));
+    }
+    return images;
+}
 
 extern "C" {
 
 JNIEXPORT jboolean JNICALL
 Java_com_shaderlay_app_shader_NativeShaderCompiler_initialize(JNIEnv *env, jobject thiz) {
-    LOGI("Initializing native shader compiler");
+    LOGD("Initializing native shader compiler");
 
     try {
         g_shaderCompiler = std::make_unique<ShaderCompiler>();
@@ -42,7 +171,7 @@ Java_com_shaderlay_app_shader_NativeShaderCompiler_initialize(JNIEnv *env, jobje
 
 JNIEXPORT void JNICALL
 Java_com_shaderlay_app_shader_NativeShaderCompiler_cleanup(JNIEnv *env, jobject thiz) {
-    LOGI("Cleaning up native shader compiler");
+    LOGD("Cleaning up native shader compiler");
 
     if (g_shaderCompiler) {
         g_shaderCompiler->cleanup();
@@ -55,6 +184,21 @@ Java_com_shaderlay_app_shader_NativeShaderCompiler_cleanup(JNIEnv *env, jobject
     }
 
     g_slangParser.reset();
+    {
+        std::lock_guard<std::mutex> lock(g_shaderArchiveMutex);
+        g_shaderArchives.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_presetIndexMutex);
+        g_presetIndex.reset();
+        g_presetIndexPath.clear();
+    }
+
+    // Joins the worker, which may still deliver cancellation callbacks
+    g_compileScheduler.reset();
+    g_frameExecutor.reset();
+
+    NativeLog::flush();
 }
 
 JNIEXPORT jstring JNICALL
@@ -123,7 +267,7 @@ Java_com_shaderlay_app_shader_NativeShaderCompiler_parseSlangPreset(
 
         env->ReleaseStringUTFChars(preset_content, presetStr);
 
-        LOGI("Slang preset parsing: %s", success ? "SUCCESS" : "FAILED");
+        LOGD("Slang preset parsing: %s", success ? "SUCCESS" : "FAILED");
         return success ? JNI_TRUE : JNI_FALSE;
 
     } catch (const std::exception& e) {
@@ -200,4 +344,698 @@ Java_com_shaderlay_app_shader_NativeShaderCompiler_validateShader(
     }
 }
 
+JNIEXPORT jintArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_getLastPrecisionReport(JNIEnv *env, jobject thiz) {
+
+    if (!g_shaderCompiler) {
+        LOGE("Shader compiler not initialized");
+        return nullptr;
+    }
+
+    PrecisionReport report = g_shaderCompiler->getLastPrecisionReport();
+    jint values[] = {
+        report.variableCount,
+        report.highpCount,
+        report.mediumpCount,
+        report.lowpCount,
+        report.downgradedCount,
+        report.upgradedCount
+    };
+
+    jintArray result = env->NewIntArray(6);
+    if (!result) {
+        LOGE("Failed to allocate precision report");
+        return nullptr;
+    }
+
+    env->SetIntArrayRegion(result, 0, 6, values);
+    return result;
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_openShaderArchive(
+        JNIEnv *env, jobject thiz, jint fd) {
+
+    try {
+        auto archive = std::make_shared<ShaderArchive>();
+        bool success = archive->openFd(fd);
+        LOGD("Shader archive open: %s", success ? "SUCCESS" : "FAILED");
+        if (!success) {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(g_shaderArchiveMutex);
+        jlong handle = g_nextShaderArchiveHandle++;
+        g_shaderArchives[handle] = std::move(archive);
+        return handle;
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during shader archive open: %s", e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_closeShaderArchive(
+        JNIEnv *env, jobject thiz, jlong handle) {
+
+    std::lock_guard<std::mutex> lock(g_shaderArchiveMutex);
+    g_shaderArchives.erase(handle);
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_listArchiveEntries(
+        JNIEnv *env, jobject thiz, jlong handle, jstring suffix) {
+
+    std::shared_ptr<ShaderArchive> archive = findShaderArchive(handle);
+    if (!archive) {
+        return nullptr;
+    }
+
+    try {
+        std::vector<std::string> names = archive->listEntries(jstringToString(env, suffix));
+
+        jclass stringClass = env->FindClass("java/lang/String");
+        jobjectArray result = env->NewObjectArray(static_cast<jsize>(names.size()), stringClass, nullptr);
+        if (!result) {
+            LOGE("Failed to allocate entry list");
+            return nullptr;
+        }
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            jstring name = env->NewStringUTF(names[i].c_str());
+            env->SetObjectArrayElement(result, static_cast<jsize>(i), name);
+            env->DeleteLocalRef(name);
+        }
+
+        return result;
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during archive listing: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_readArchiveText(
+        JNIEnv *env, jobject thiz, jlong handle, jstring preset_path, jstring relative_path) {
+
+    std::shared_ptr<ShaderArchive> archive = findShaderArchive(handle);
+    if (!archive) {
+        return nullptr;
+    }
+
+    try {
+        std::string path = ShaderArchive::resolvePath(jstringToString(env, preset_path),
+                                                      jstringToString(env, relative_path));
+        std::string text = archive->readText(path);
+
+        if (text.empty()) {
+            LOGE("Failed to read archive entry: %s", path.c_str());
+            return nullptr;
+        }
+
+        return env->NewStringUTF(text.c_str());
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during archive read: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_readArchiveBytes(
+        JNIEnv *env, jobject thiz, jlong handle, jstring preset_path, jstring relative_path) {
+
+    std::shared_ptr<ShaderArchive> archive = findShaderArchive(handle);
+    if (!archive) {
+        return nullptr;
+    }
+
+    try {
+        std::string path = ShaderArchive::resolvePath(jstringToString(env, preset_path),
+                                                      jstringToString(env, relative_path));
+
+        jbyteArray result = nullptr;
+        ArchiveEntryView view;
+        if (archive->getStoredView(path, view)) {
+            // Stored entries copy straight from the mapping into the Java array
+            result = env->NewByteArray(static_cast<jsize>(view.size));
+            if (result) {
+                env->SetByteArrayRegion(result, 0, static_cast<jsize>(view.size),
+                                        reinterpret_cast<const jbyte*>(view.data));
+            }
+        } else {
+            std::vector<uint8_t> bytes = archive->readBytes(path);
+            if (bytes.empty()) {
+                LOGE("Failed to read archive entry: %s", path.c_str());
+                return nullptr;
+            }
+            result = env->NewByteArray(static_cast<jsize>(bytes.size()));
+            if (result) {
+                env->SetByteArrayRegion(result, 0, static_cast<jsize>(bytes.size()),
+                                        reinterpret_cast<const jbyte*>(bytes.data()));
+            }
+        }
+
+        return result;
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during archive read: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jintArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_updatePackPresetIndex(
+        JNIEnv *env, jobject thiz, jlong handle, jstring pack_key, jstring index_path) {
+
+    std::shared_ptr<ShaderArchive> archive = findShaderArchive(handle);
+    if (!archive) {
+        return nullptr;
+    }
+
+    try {
+        std::string packKey = jstringToString(env, pack_key);
+        std::string indexPath = jstringToString(env, index_path);
+
+        std::lock_guard<std::mutex> lock(g_presetIndexMutex);
+        if (!g_presetIndex || g_presetIndexPath != indexPath) {
+            g_presetIndex = std::make_unique<PresetIndex>();
+            g_presetIndex->load(indexPath);
+            g_presetIndexPath = indexPath;
+        }
+
+        IndexStats stats = g_presetIndex->updateArchive(*archive, packKey);
+        if (stats.dirty) {
+            g_presetIndex->save(indexPath);
+        }
+
+        jint values[] = { stats.scanned, stats.reparsed, stats.reused, stats.removed };
+        jintArray result = env->NewIntArray(4);
+        if (!result) {
+            LOGE("Failed to allocate index stats");
+            return nullptr;
+        }
+
+        env->SetIntArrayRegion(result, 0, 4, values);
+        return result;
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during preset indexing: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_getIndexedPresetPaths(JNIEnv *env, jobject thiz) {
+
+    std::lock_guard<std::mutex> lock(g_presetIndexMutex);
+    if (!g_presetIndex) {
+        LOGE("Preset index not loaded");
+        return nullptr;
+    }
+
+    const auto& presets = g_presetIndex->getPresets();
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(presets.size()), stringClass, nullptr);
+    if (!result) {
+        LOGE("Failed to allocate preset list");
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < presets.size(); ++i) {
+        jstring path = env->NewStringUTF(presets[i].path.c_str());
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), path);
+        env->DeleteLocalRef(path);
+    }
+
+    return result;
+}
+
+JNIEXPORT jintArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_getIndexedPresetPassCounts(JNIEnv *env, jobject thiz) {
+
+    std::lock_guard<std::mutex> lock(g_presetIndexMutex);
+    if (!g_presetIndex) {
+        LOGE("Preset index not loaded");
+        return nullptr;
+    }
+
+    // Invalid presets report 0 passes
+    const auto& presets = g_presetIndex->getPresets();
+    std::vector<jint> counts;
+    counts.reserve(presets.size());
+    for (const auto& preset : presets) {
+        counts.push_back(preset.valid ? preset.passCount : 0);
+    }
+
+    jintArray result = env->NewIntArray(static_cast<jsize>(counts.size()));
+    if (!result) {
+        LOGE("Failed to allocate pass counts");
+        return nullptr;
+    }
+
+    env->SetIntArrayRegion(result, 0, static_cast<jsize>(counts.size()), counts.data());
+    return result;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_analyzeOutputDependency(
+        JNIEnv *env, jobject thiz, jstring source) {
+
+    // Stateless; usable before initialize()
+    try {
+        RenderDependencyAnalyzer analyzer;
+        PassDependency pass = analyzer.analyzePass(jstringToString(env, source));
+        return static_cast<jint>(pass.dependency);
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during dependency analysis: %s", e.what());
+        return static_cast<jint>(OutputDependency::TimeDependent);
+    }
+}
+
+JNIEXPORT jintArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_analyzePresetDependency(
+        JNIEnv *env, jobject thiz, jstring preset_content, jobjectArray pass_sources) {
+
+    try {
+        SlangParser parser;
+        if (!parser.parseSlangPreset(jstringToString(env, preset_content))) {
+            LOGE("Slang preset parsing failed");
+            return nullptr;
+        }
+
+        std::vector<std::string> sources = jstringArrayToVector(env, pass_sources);
+        size_t passCount = parser.getPreset().shaders.size();
+        if (sources.size() < passCount) {
+            // Passes without a source keep the conservative default
+            LOGW("Dependency analysis has %zu sources for %zu passes", sources.size(), passCount);
+        }
+
+        RenderDependencyAnalyzer analyzer;
+        std::vector<PassDependency> passes;
+        for (size_t i = 0; i < passCount; ++i) {
+            passes.push_back(i < sources.size() ? analyzer.analyzePass(sources[i]) : PassDependency{});
+        }
+
+        // [preset, pass0, pass1, ...]
+        std::vector<jint> values;
+        values.push_back(static_cast<jint>(analyzer.analyzePreset(passes)));
+        for (const auto& pass : passes) {
+            values.push_back(static_cast<jint>(pass.dependency));
+        }
+
+        jintArray result = env->NewIntArray(static_cast<jsize>(values.size()));
+        if (!result) {
+            LOGE("Failed to allocate dependency report");
+            return nullptr;
+        }
+
+        env->SetIntArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+        return result;
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during preset dependency analysis: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_submitPresetCompile(
+        JNIEnv *env, jobject thiz, jstring preset_content, jobjectArray pass_sources,
+        jint priority, jobject listener) {
+
+    try {
+        if (!g_javaVM && env->GetJavaVM(&g_javaVM) != JNI_OK) {
+            LOGE("Failed to get JavaVM");
+            return 0;
+        }
+
+        if (!g_compileScheduler) {
+            g_compileScheduler = std::make_unique<CompileScheduler>();
+        }
+
+        jclass listenerClass = env->GetObjectClass(listener);
+        jmethodID onPassCompiled = env->GetMethodID(listenerClass, "onPassCompiled", "(JILjava/lang/String;)V");
+        jmethodID onJobFinished = env->GetMethodID(listenerClass, "onJobFinished", "(JILjava/lang/String;)V");
+        if (!onPassCompiled || !onJobFinished) {
+            LOGE("Compile listener is missing callbacks");
+            return 0;
+        }
+
+        std::string content = jstringToString(env, preset_content);
+        std::vector<std::string> sources = jstringArrayToVector(env, pass_sources);
+
+        // Owned by onFinish once the job is queued; released here if submit throws
+        GlobalRefGuard listenerGuard(env, env->NewGlobalRef(listener));
+        jobject listenerRef = listenerGuard.get();
+
+        auto onPass = [listenerRef, onPassCompiled](uint64_t ticket, const CompiledPass& pass) {
+            JNIEnv* workerEnv = getWorkerEnv();
+            if (!workerEnv) return;
+
+            jstring source = workerEnv->NewStringUTF(pass.fragmentSource.c_str());
+            workerEnv->CallVoidMethod(listenerRef, onPassCompiled,
+                                      static_cast<jlong>(ticket), static_cast<jint>(pass.index), source);
+            workerEnv->DeleteLocalRef(source);
+            if (workerEnv->ExceptionCheck()) {
+                LOGE("Exception in onPassCompiled");
+                workerEnv->ExceptionClear();
+            }
+        };
+
+        auto onFinish = [listenerRef, onJobFinished](uint64_t ticket, CompileStatus status,
+                                                     const std::string& message) {
+            JNIEnv* workerEnv = getWorkerEnv();
+            if (!workerEnv) return;
+
+            jstring text = message.empty() ? nullptr : workerEnv->NewStringUTF(message.c_str());
+            workerEnv->CallVoidMethod(listenerRef, onJobFinished,
+                                      static_cast<jlong>(ticket), static_cast<jint>(status), text);
+            workerEnv->DeleteLocalRef(text);
+            if (workerEnv->ExceptionCheck()) {
+                LOGE("Exception in onJobFinished");
+                workerEnv->ExceptionClear();
+            }
+            workerEnv->DeleteGlobalRef(listenerRef);
+        };
+
+        uint64_t ticket = g_compileScheduler->submit(content, std::move(sources), priority, onPass, onFinish);
+        listenerGuard.release();
+        return static_cast<jlong>(ticket);
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during compile submission: %s", e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_cancelCompile(
+        JNIEnv *env, jobject thiz, jlong ticket) {
+
+    if (!g_compileScheduler) {
+        return JNI_FALSE;
+    }
+    return g_compileScheduler->cancel(static_cast<uint64_t>(ticket)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_cancelAllCompilesExcept(
+        JNIEnv *env, jobject thiz, jlong ticket) {
+
+    if (g_compileScheduler) {
+        g_compileScheduler->cancelAllExcept(static_cast<uint64_t>(ticket));
+    }
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_getLastCompileArenaStats(JNIEnv *env, jobject thiz) {
+
+    if (!g_compileScheduler) {
+        return nullptr;
+    }
+
+    ArenaStats stats = g_compileScheduler->getLastArenaStats();
+    jlong values[] = {
+        static_cast<jlong>(stats.bytesUsed),
+        static_cast<jlong>(stats.allocationCount),
+        static_cast<jlong>(stats.peakBytesUsed),
+        static_cast<jlong>(stats.reservedBytes)
+    };
+
+    jlongArray result = env->NewLongArray(4);
+    if (!result) {
+        LOGE("Failed to allocate arena stats");
+        return nullptr;
+    }
+
+    env->SetLongArrayRegion(result, 0, 4, values);
+    return result;
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_estimatePassCost(
+        JNIEnv *env, jobject thiz, jstring source) {
+
+    // Stateless; usable before initialize()
+    try {
+        GpuCostEstimator estimator;
+        PassCost pass = estimator.analyzePass(jstringToString(env, source));
+        jfloat values[] = {
+            static_cast<jfloat>(pass.textureFetches),
+            static_cast<jfloat>(pass.aluOps),
+            static_cast<jfloat>(pass.loopIterations),
+            static_cast<jfloat>(pass.pixelCost)
+        };
+
+        jfloatArray result = env->NewFloatArray(4);
+        if (!result) {
+            LOGE("Failed to allocate pass cost");
+            return nullptr;
+        }
+
+        env->SetFloatArrayRegion(result, 0, 4, values);
+        return result;
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during pass cost estimation: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_estimatePresetCost(
+        JNIEnv *env, jobject thiz, jstring preset_content, jobjectArray pass_sources,
+        jint source_width, jint source_height, jint viewport_width, jint viewport_height) {
+
+    try {
+        SlangParser parser;
+        if (!parser.parseSlangPreset(jstringToString(env, preset_content))) {
+            LOGE("Slang preset parsing failed");
+            return nullptr;
+        }
+
+        std::vector<std::string> sources = jstringArrayToVector(env, pass_sources);
+
+        GpuCostEstimator estimator;
+        PresetCost cost = estimator.estimatePreset(parser.getPreset(), sources,
+                                                   source_width, source_height,
+                                                   viewport_width, viewport_height);
+
+        // [frame, pass0, pass1, ...]
+        std::vector<jfloat> values;
+        values.push_back(static_cast<jfloat>(cost.frameCost));
+        for (const auto& pass : cost.passes) {
+            values.push_back(static_cast<jfloat>(pass.frameCost));
+        }
+
+        jfloatArray result = env->NewFloatArray(static_cast<jsize>(values.size()));
+        if (!result) {
+            LOGE("Failed to allocate preset cost");
+            return nullptr;
+        }
+
+        env->SetFloatArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+        return result;
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during preset cost estimation: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_estimateFrameTimeMs(
+        JNIEnv *env, jobject thiz, jfloat frame_cost, jstring renderer) {
+
+    return static_cast<jfloat>(
+        GpuCostEstimator::estimateFrameTimeMs(frame_cost, jstringToString(env, renderer)));
+}
+
+JNIEXPORT jint JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_selectShaderTier(
+        JNIEnv *env, jobject thiz, jfloatArray frame_costs, jstring renderer, jfloat frame_budget_ms) {
+
+    jsize count = env->GetArrayLength(frame_costs);
+    std::vector<jfloat> values(static_cast<size_t>(count));
+    env->GetFloatArrayRegion(frame_costs, 0, count, values.data());
+
+    std::vector<double> costs(values.begin(), values.end());
+    return GpuCostEstimator::selectTier(costs, jstringToString(env, renderer), frame_budget_ms);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_buildPresetChain(
+        JNIEnv *env, jobject thiz, jstring preset_content, jobjectArray pass_sources,
+        jboolean precompiled, jint width, jint height, jboolean headless,
+        jobjectArray texture_names, jintArray texture_sizes, jobjectArray texture_pixels) {
+
+    // Called on the GL thread; the executor owns GL objects in its context
+    try {
+        SlangParser parser;
+        if (!parser.parseSlangPreset(jstringToString(env, preset_content))) {
+            LOGE("Slang preset parsing failed");
+            return JNI_FALSE;
+        }
+
+        // Sources from submitPresetCompile are already compiled
+        std::vector<std::string> fragments = jstringArrayToVector(env, pass_sources);
+        if (precompiled != JNI_TRUE) {
+            ShaderCompiler compiler;
+            compiler.initialize();
+            for (auto& fragment : fragments) {
+                fragment = compiler.compileSlangPass(fragment);
+            }
+        }
+
+        // Keeping the executor lets build() reuse the passes the
+        // previous preset shares with this one
+        bool wantHeadless = headless == JNI_TRUE;
+        if (!g_frameExecutor || g_frameExecutorHeadless != wantHeadless) {
+            std::unique_ptr<RenderBackend> backend;
+            if (wantHeadless) {
+                backend = std::make_unique<RecordingBackend>();
+            } else {
+                backend = std::make_unique<GlesBackend>();
+            }
+            g_frameExecutor = std::make_unique<FrameExecutor>(std::move(backend));
+            g_frameExecutorHeadless = wantHeadless;
+        }
+
+        std::vector<LookupImage> images = lookupImagesFromArrays(env, texture_names, texture_sizes,
+                                                                 texture_pixels);
+        if (!g_frameExecutor->build(parser.getPreset(), fragments, width, height, images)) {
+            g_frameExecutor.reset();
+            return JNI_FALSE;
+        }
+        return JNI_TRUE;
+
+    } catch (const std::exception& e) {
+        LOGE("Exception while building preset chain: %s", e.what());
+        g_frameExecutor.reset();
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_resizePresetChain(
+        JNIEnv *env, jobject thiz, jint width, jint height) {
+
+    if (!g_frameExecutor) {
+        return JNI_FALSE;
+    }
+    return g_frameExecutor->resize(width, height) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_renderPresetFrame(
+        JNIEnv *env, jobject thiz, jfloat time_seconds, jfloat opacity) {
+
+    // The only JNI crossing per frame
+    if (!g_frameExecutor || !g_frameExecutor->isReady()) {
+        return JNI_FALSE;
+    }
+
+    FrameInputs inputs;
+    inputs.timeSeconds = time_seconds;
+    inputs.opacity = opacity;
+    g_frameExecutor->renderFrame(inputs);
+    return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_releasePresetChain(
+        JNIEnv *env, jobject thiz, jboolean context_lost) {
+
+    if (g_frameExecutor) {
+        g_frameExecutor->release(context_lost);
+        g_frameExecutor.reset();
+    }
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_getPresetChainStats(JNIEnv *env, jobject thiz) {
+
+    if (!g_frameExecutor) {
+        return nullptr;
+    }
+
+    FrameStats stats = g_frameExecutor->getStats();
+    jfloat values[] = {
+        static_cast<jfloat>(stats.frames),
+        static_cast<jfloat>(stats.passes),
+        static_cast<jfloat>(stats.drawCalls),
+        static_cast<jfloat>(stats.stateCalls),
+        static_cast<jfloat>(stats.uniformCalls),
+        static_cast<jfloat>(stats.lastCpuMs),
+        static_cast<jfloat>(stats.averageCpuMs)
+    };
+
+    jfloatArray result = env->NewFloatArray(7);
+    if (!result) {
+        LOGE("Failed to allocate chain stats");
+        return nullptr;
+    }
+
+    env->SetFloatArrayRegion(result, 0, 7, values);
+    return result;
+}
+
+JNIEXPORT jintArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_getPresetChainBuildStats(JNIEnv *env, jobject thiz) {
+
+    if (!g_frameExecutor) {
+        return nullptr;
+    }
+
+    BuildStats stats = g_frameExecutor->getLastBuildStats();
+    jint values[] = {
+        stats.passes,
+        stats.reusedPasses,
+        stats.reusedPrograms,
+        stats.compiledPrograms,
+        stats.reusedTargets,
+        stats.createdTargets,
+        stats.reusedTextures,
+        stats.createdTextures
+    };
+
+    jintArray result = env->NewIntArray(8);
+    if (!result) {
+        LOGE("Failed to allocate build stats");
+        return nullptr;
+    }
+
+    env->SetIntArrayRegion(result, 0, 8, values);
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_flushNativeLog(JNIEnv *env, jobject thiz) {
+    NativeLog::flush();
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_com_shaderlay_app_shader_NativeShaderCompiler_getNativeLogStats(JNIEnv *env, jobject thiz) {
+
+    NativeLogStats stats = NativeLog::getStats();
+    jlong values[] = {
+        static_cast<jlong>(stats.written),
+        static_cast<jlong>(stats.rateLimited),
+        static_cast<jlong>(stats.overflowed)
+    };
+
+    jlongArray result = env->NewLongArray(3);
+    if (!result) {
+        LOGE("Failed to allocate log stats");
+        return nullptr;
+    }
+
+    env->SetLongArrayRegion(result, 0, 3, values);
+    return result;
+}
+
 } // extern "C"
\ No newline at end of file
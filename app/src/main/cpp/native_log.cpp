@@ -0,0 +1,218 @@
+#include "native_log.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+#define LOG_TAG "NativeLog"
+
+namespace Shaderlay {
+
+namespace {
+
+constexpr size_t kRingCapacity = 256;          // Power of two
+constexpr size_t kMessageSize = 256;
+constexpr uint32_t kSiteBurst = 20;            // Messages per call site per second
+constexpr auto kFlushInterval = std::chrono::milliseconds(250);
+
+struct Slot {
+    std::atomic<size_t> sequence{0};
+    int level = 0;
+    const char* tag = nullptr;
+    char message[kMessageSize];
+};
+
+uint32_t nowSeconds() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void emit(int level, const char* tag, const char* message) {
+#ifdef __ANDROID__
+    static const int kPriorities[] = {
+        ANDROID_LOG_VERBOSE, ANDROID_LOG_DEBUG, ANDROID_LOG_INFO, ANDROID_LOG_WARN, ANDROID_LOG_ERROR
+    };
+    __android_log_write(kPriorities[level], tag, message);
+#else
+    static const char kLetters[] = "VDIWE";
+    std::fprintf(stderr, "%c/%s: %s\n", kLetters[level], tag, message);
+#endif
+}
+
+// Bounded multi-producer ring with per-slot sequence numbers. Producers
+// claim a slot with one CAS and never wait; the single consumer runs
+// under drainMutex_, either on the flusher thread or in flush().
+class Logger {
+public:
+    Logger() {
+        for (size_t i = 0; i < kRingCapacity; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        std::thread(&Logger::flusherLoop, this).detach();
+    }
+
+    void push(int level, const char* tag, const char* format, va_list args) {
+        size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[position & (kRingCapacity - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1,
+                                                           std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                overflowed_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        slot->tag = tag;
+        std::vsnprintf(slot->message, kMessageSize, format, args);
+        slot->sequence.store(position + 1, std::memory_order_release);
+
+        // Waking costs a syscall, so only warnings and a filling ring do it;
+        // everything else waits for the next interval
+        size_t pending = position + 1 - dequeuePosition_.load(std::memory_order_relaxed);
+        if (level >= SHADERLAY_LOG_WARN || pending >= kRingCapacity / 2) {
+            wakeRequested_.store(true, std::memory_order_relaxed);
+            wake_.notify_one();
+        }
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(drainMutex_);
+        drain();
+    }
+
+    void countRateLimited() {
+        rateLimited_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    NativeLogStats getStats() const {
+        NativeLogStats stats;
+        stats.written = written_.load(std::memory_order_relaxed);
+        stats.rateLimited = rateLimited_.load(std::memory_order_relaxed);
+        stats.overflowed = overflowed_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    void flusherLoop() {
+        std::unique_lock<std::mutex> lock(drainMutex_);
+        for (;;) {
+            wake_.wait_for(lock, kFlushInterval, [this] {
+                return wakeRequested_.load(std::memory_order_relaxed);
+            });
+            wakeRequested_.store(false, std::memory_order_relaxed);
+            drain();
+        }
+    }
+
+    // Caller holds drainMutex_
+    void drain() {
+        size_t position = dequeuePosition_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[position & (kRingCapacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+
+            emit(slot.level, slot.tag, slot.message);
+            slot.sequence.store(position + kRingCapacity, std::memory_order_release);
+            position++;
+            dequeuePosition_.store(position, std::memory_order_relaxed);
+            written_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Report drops once per drain rather than per message
+        uint64_t dropped = rateLimited_.load(std::memory_order_relaxed) +
+                           overflowed_.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops_) {
+            char message[64];
+            std::snprintf(message, sizeof(message), "%llu log messages dropped",
+                          static_cast<unsigned long long>(dropped - reportedDrops_));
+            emit(SHADERLAY_LOG_WARN, LOG_TAG, message);
+            reportedDrops_ = dropped;
+        }
+    }
+
+    Slot slots_[kRingCapacity];
+    alignas(64) std::atomic<size_t> enqueuePosition_{0};
+    alignas(64) std::atomic<size_t> dequeuePosition_{0};
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> rateLimited_{0};
+    std::atomic<uint64_t> overflowed_{0};
+    uint64_t reportedDrops_ = 0;
+
+    std::mutex drainMutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> wakeRequested_{false};
+};
+
+// Never destroyed: worker threads owned by other globals may still log
+// while static destructors run. Pending messages are flushed at exit.
+Logger& logger() {
+    static Logger* instance = [] {
+        Logger* created = new Logger();
+        std::atexit([] { logger().flush(); });
+        return created;
+    }();
+    return *instance;
+}
+
+// Fixed one-second windows; racing threads may let a few extra through
+bool admit(LogSite& site) {
+    uint32_t now = nowSeconds();
+    uint32_t start = site.windowStart.load(std::memory_order_relaxed);
+    if (start != now && site.windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        site.count.store(0, std::memory_order_relaxed);
+    }
+    return site.count.fetch_add(1, std::memory_order_relaxed) < kSiteBurst;
+}
+
+} // namespace
+
+namespace NativeLog {
+
+void write(int level, const char* tag, LogSite& site, const char* format, ...) {
+    if (level < SHADERLAY_LOG_VERBOSE || level > SHADERLAY_LOG_ERROR) {
+        return;
+    }
+
+    Logger& instance = logger();
+    if (!admit(site)) {
+        instance.countRateLimited();
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    instance.push(level, tag, format, args);
+    va_end(args);
+}
+
+void flush() {
+    logger().flush();
+}
+
+NativeLogStats getStats() {
+    return logger().getStats();
+}
+
+} // namespace NativeLog
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Log levels, lowest first. Calls below SHADERLAY_MIN_LOG_LEVEL compile
+// to nothing: their arguments are type-checked but never evaluated.
+#define SHADERLAY_LOG_VERBOSE 0
+#define SHADERLAY_LOG_DEBUG 1
+#define SHADERLAY_LOG_INFO 2
+#define SHADERLAY_LOG_WARN 3
+#define SHADERLAY_LOG_ERROR 4
+#define SHADERLAY_LOG_NONE 5
+
+#ifndef SHADERLAY_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define SHADERLAY_MIN_LOG_LEVEL SHADERLAY_LOG_WARN
+#else
+#define SHADERLAY_MIN_LOG_LEVEL SHADERLAY_LOG_DEBUG
+#endif
+#endif
+
+namespace Shaderlay {
+
+struct NativeLogStats {
+    uint64_t written = 0;         // Delivered to the sink
+    uint64_t rateLimited = 0;     // Dropped by a call site over its budget
+    uint64_t overflowed = 0;      // Dropped because the ring was full
+};
+
+// Rate limit state of one call site. Constant-initialized, so the static
+// in SHADERLAY_LOG needs no initialization guard.
+struct LogSite {
+    std::atomic<uint32_t> windowStart{0};
+    std::atomic<uint32_t> count{0};
+};
+
+// Messages are formatted on the calling thread into a lock-free ring and
+// handed to the platform sink (logcat on Android, stderr elsewhere) by a
+// background flusher, so callers never block on the log syscall.
+namespace NativeLog {
+
+// tag must be a string literal; only the pointer is queued
+void write(int level, const char* tag, LogSite& site, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+// Drains the ring on the calling thread
+void flush();
+
+NativeLogStats getStats();
+
+} // namespace NativeLog
+
+} // namespace Shaderlay
+
+#define SHADERLAY_LOG(level, ...)                                                           \
+    do {                                                                                    \
+        if constexpr ((level) >= SHADERLAY_MIN_LOG_LEVEL) {                                 \
+            static ::Shaderlay::LogSite shaderlayLogSite;                                   \
+            ::Shaderlay::NativeLog::write((level), LOG_TAG, shaderlayLogSite, __VA_ARGS__); \
+        }                                                                                   \
+    } while (0)
+
+#define LOGV(...) SHADERLAY_LOG(SHADERLAY_LOG_VERBOSE, __VA_ARGS__)
+#define LOGD(...) SHADERLAY_LOG(SHADERLAY_LOG_DEBUG, __VA_ARGS__)
+#define LOGI(...) SHADERLAY_LOG(SHADERLAY_LOG_INFO, __VA_ARGS__)
+#define LOGW(...) SHADERLAY_LOG(SHADERLAY_LOG_WARN, __VA_ARGS__)
+#define LOGE(...) SHADERLAY_LOG(SHADERLAY_LOG_ERROR, __VA_ARGS__)
\ No newline at end of file
@@ -0,0 +1,1271 @@
+#include "precision_analyzer.h"
+#include "glsl_lexer.h"
+#include "native_log.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+#define LOG_TAG "PrecisionAnalyzer"
+
+namespace Shaderlay {
+
+namespace {
+
+// Minimum guaranteed ranges from the GLSL ES 1.00 specification
+constexpr double kLowpRange = 2.0;
+constexpr double kMediumpRange = 16384.0;
+constexpr double kUnbounded = std::numeric_limits<double>::infinity();
+
+const char* const kHighpMacro = "SHADERLAY_HIGHP";
+
+bool isFloatType(std::string_view word) {
+    return word == "float" ||
+           word == "vec2" || word == "vec3" || word == "vec4" ||
+           word == "mat2" || word == "mat3" || word == "mat4";
+}
+
+bool isTypeKeyword(std::string_view word) {
+    return isFloatType(word) || word == "void" || word == "int" || word == "bool" ||
+           word == "ivec2" || word == "ivec3" || word == "ivec4" ||
+           word == "bvec2" || word == "bvec3" || word == "bvec4" ||
+           word == "sampler2D" || word == "samplerCube";
+}
+
+bool isPrecisionQualifier(std::string_view word) {
+    return word == "lowp" || word == "mediump" || word == "highp";
+}
+
+bool isStorageQualifier(std::string_view word) {
+    return word == "uniform" || word == "varying" || word == "const" ||
+           word == "attribute" || word == "in" || word == "out" || word == "inout";
+}
+
+Precision parsePrecision(std::string_view word) {
+    if (word == "lowp") return Precision::Low;
+    if (word == "highp") return Precision::High;
+    return Precision::Medium;
+}
+
+// Uniform names that conventionally carry pixel sizes, clocks or counters
+bool isLargeRangeUniform(std::string_view name) {
+    static const std::string_view kHints[] = {
+        "resolution", "size", "time", "frame", "phase", "count"
+    };
+    auto sameLower = [](char c, char hint) { return std::tolower(static_cast<unsigned char>(c)) == hint; };
+    for (std::string_view hint : kHints) {
+        if (std::search(name.begin(), name.end(), hint.begin(), hint.end(), sameLower) != name.end()) return true;
+    }
+    return false;
+}
+
+Precision literalPrecision(const ArenaString& literal) {
+    double value = std::fabs(std::strtod(literal.c_str(), nullptr));
+    if (value > kMediumpRange) return Precision::High;
+    if (value > kLowpRange) return Precision::Medium;
+    return Precision::Low;
+}
+
+// Index of the ')' matching the '(' at openIndex, or tokens.size()
+size_t findClosingParen(const GlslTokenList& tokens, size_t openIndex, size_t end) {
+    int depth = 0;
+    for (size_t i = openIndex; i < end; ++i) {
+        if (tokens[i].text == "(") depth++;
+        else if (tokens[i].text == ")" && --depth == 0) return i;
+    }
+    return end;
+}
+
+// Split tokens (begin, close) into comma-separated argument ranges
+ArenaVector<std::pair<size_t, size_t>> splitArguments(const GlslTokenList& tokens, size_t open, size_t close) {
+    ArenaVector<std::pair<size_t, size_t>> args;
+    int depth = 0;
+    size_t argStart = open + 1;
+
+    for (size_t i = open + 1; i < close; ++i) {
+        const ArenaString& t = tokens[i].text;
+        if (t == "(" || t == "[") depth++;
+        else if (t == ")" || t == "]") depth--;
+        else if (t == "," && depth == 0) {
+            args.emplace_back(argStart, i);
+            argStart = i + 1;
+        }
+    }
+    if (argStart < close) {
+        args.emplace_back(argStart, close);
+    }
+    return args;
+}
+
+// Copy of tokens [begin, end)
+GlslTokenList tokenSlice(const GlslTokenList& tokens, size_t begin, size_t end) {
+    if (begin >= end) return {};
+    return GlslTokenList(tokens.begin() + begin, tokens.begin() + end);
+}
+
+// End of an expression starting at begin: the first top-level ',' ';' or unmatched ')'
+size_t findExpressionEnd(const GlslTokenList& tokens, size_t begin) {
+    int depth = 0;
+    for (size_t i = begin; i < tokens.size(); ++i) {
+        const ArenaString& t = tokens[i].text;
+        if (t == "(" || t == "[") depth++;
+        else if (t == ")" || t == "]") {
+            if (depth == 0) return i;
+            depth--;
+        } else if ((t == "," || t == ";") && depth == 0) {
+            return i;
+        }
+    }
+    return tokens.size();
+}
+
+// Variable indices read by the expression being evaluated. Ranges refer
+// to slices of it, so combining operands rarely copies anything.
+using SourceList = ArenaVector<size_t>;
+
+// Values an expression can take, the highest precision among its inputs,
+// and the variables whose precision the result is computed at, as the
+// slice [sourcesBegin, sourcesEnd) of the evaluation's SourceList
+struct ValueRange {
+    double low = -kUnbounded;
+    double high = kUnbounded;
+    Precision precision = Precision::Low;
+    size_t sourcesBegin = 0;
+    size_t sourcesEnd = 0;
+
+    bool hasSources() const { return sourcesEnd > sourcesBegin; }
+    void clearSources() { sourcesBegin = sourcesEnd = 0; }
+};
+
+ValueRange constantRange(double value, Precision precision) {
+    ValueRange range;
+    range.low = value;
+    range.high = value;
+    range.precision = precision;
+    return range;
+}
+
+ValueRange unboundedRange(Precision precision) {
+    ValueRange range;
+    range.precision = precision;
+    return range;
+}
+
+double magnitude(const ValueRange& range) {
+    return std::max(std::fabs(range.low), std::fabs(range.high));
+}
+
+// Lowest precision whose guaranteed range holds every value in range.
+// Unknown ranges keep the default; only known large values need highp.
+Precision rangePrecision(const ValueRange& range) {
+    double limit = magnitude(range);
+    if (std::isinf(limit) || std::isnan(limit)) return Precision::Medium;
+    if (limit > kMediumpRange) return Precision::High;
+    if (limit > kLowpRange) return Precision::Medium;
+    return Precision::Low;
+}
+
+// Precision and sources of an operation over a and b. Operands parsed
+// one after the other have adjacent slices, which are joined in place;
+// only otherwise are both copied to the end of the list.
+ValueRange combine(const ValueRange& a, const ValueRange& b, SourceList& sources) {
+    ValueRange result;
+    result.precision = std::max(a.precision, b.precision);
+
+    if (!b.hasSources()) {
+        result.sourcesBegin = a.sourcesBegin;
+        result.sourcesEnd = a.sourcesEnd;
+    } else if (!a.hasSources()) {
+        result.sourcesBegin = b.sourcesBegin;
+        result.sourcesEnd = b.sourcesEnd;
+    } else if (a.sourcesEnd == b.sourcesBegin) {
+        result.sourcesBegin = a.sourcesBegin;
+        result.sourcesEnd = b.sourcesEnd;
+    } else {
+        result.sourcesBegin = sources.size();
+        for (size_t i = a.sourcesBegin; i < a.sourcesEnd; ++i) sources.push_back(sources[i]);
+        for (size_t i = b.sourcesBegin; i < b.sourcesEnd; ++i) sources.push_back(sources[i]);
+        result.sourcesEnd = sources.size();
+    }
+    return result;
+}
+
+ValueRange hull(const ValueRange& a, const ValueRange& b, SourceList& sources) {
+    ValueRange result = combine(a, b, sources);
+    result.low = std::min(a.low, b.low);
+    result.high = std::max(a.high, b.high);
+    return result;
+}
+
+// 0 * inf is 0 for bounds
+double boundProduct(double a, double b) {
+    return (a == 0.0 || b == 0.0) ? 0.0 : a * b;
+}
+
+ValueRange arithmetic(std::string_view op, const ValueRange& a, const ValueRange& b, SourceList& sources) {
+    ValueRange result = combine(a, b, sources);
+
+    if (op == "+") {
+        result.low = a.low + b.low;
+        result.high = a.high + b.high;
+    } else if (op == "-") {
+        result.low = a.low - b.high;
+        result.high = a.high - b.low;
+    } else if (op == "*" || (op == "/" && (b.low > 0.0 || b.high < 0.0))) {
+        double low = b.low;
+        double high = b.high;
+        if (op == "/") {
+            low = 1.0 / b.high;
+            high = 1.0 / b.low;
+        }
+        double products[] = {
+            boundProduct(a.low, low), boundProduct(a.low, high),
+            boundProduct(a.high, low), boundProduct(a.high, high)
+        };
+        result.low = *std::min_element(std::begin(products), std::end(products));
+        result.high = *std::max_element(std::begin(products), std::end(products));
+    }
+    // Division by a range containing zero stays unbounded
+
+    if (std::isnan(result.low) || std::isnan(result.high)) {
+        result.low = -kUnbounded;
+        result.high = kUnbounded;
+    }
+    return result;
+}
+
+// Built-ins whose result range does not depend on the magnitude of their
+// arguments. The arguments are still evaluated at whatever precision they
+// carry; only the stored result is small.
+struct BoundedFunction {
+    const char* name;
+    double low;
+    double high;
+};
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr BoundedFunction kBoundedFunctions[] = {
+    {"sin", -1.0, 1.0}, {"cos", -1.0, 1.0},
+    {"asin", -kPi / 2.0, kPi / 2.0}, {"acos", 0.0, kPi}, {"atan", -kPi, kPi},
+    {"fract", 0.0, 1.0}, {"sign", -1.0, 1.0}, {"step", 0.0, 1.0}, {"smoothstep", 0.0, 1.0},
+    {"normalize", -1.0, 1.0},
+    {"dFdx", -kUnbounded, kUnbounded}, {"dFdy", -kUnbounded, kUnbounded},
+    {"fwidth", 0.0, kUnbounded},
+    {"texture2D", 0.0, 1.0}, {"texture2DProj", 0.0, 1.0}, {"texture2DLod", 0.0, 1.0},
+    {"texture2DProjLod", 0.0, 1.0}, {"textureCube", 0.0, 1.0}, {"textureCubeLod", 0.0, 1.0},
+    {"texture", 0.0, 1.0}, {"textureLod", 0.0, 1.0}
+};
+
+// Built-ins that reduce coordinates to a value, such as a distance or a
+// falloff. Their arguments are evaluated at the precision they carry, but
+// the result is not a coordinate, so it only needs the precision its range
+// calls for.
+bool isValueFunction(std::string_view name) {
+    return name == "dot" || name == "length" || name == "distance" ||
+           name == "pow" || name == "exp" || name == "exp2" || name == "log" || name == "log2" ||
+           name == "sqrt" || name == "inversesqrt";
+}
+
+const BoundedFunction* findBoundedFunction(std::string_view word) {
+    for (const auto& function : kBoundedFunctions) {
+        if (word == function.name) return &function;
+    }
+    return nullptr;
+}
+
+// Tracks which function body or global struct/block a token walk is in.
+// visit() must see every token that can open or close a block, plus the
+// return type of each function definition.
+class FunctionScope {
+public:
+    void visit(const GlslTokenList& tokens, size_t i) {
+        const ArenaString& text = tokens[i].text;
+        if (text == "{") {
+            // Struct and interface block bodies do not follow a parameter list
+            if (depth_ == 0) {
+                bool function = i > 0 && tokens[i - 1].text == ")";
+                current_ = function ? pending_ : std::string_view();
+                aggregate_ = !function;
+                uniformBlock_ = !function && i >= 2 && tokens[i - 2].text == "uniform";
+            }
+            depth_++;
+        } else if (text == "}") {
+            if (depth_ > 0 && --depth_ == 0) {
+                current_ = std::string_view();
+                aggregate_ = false;
+                uniformBlock_ = false;
+            }
+        } else if (depth_ == 0 && isTypeKeyword(text) && i + 2 < tokens.size() &&
+                   tokens[i + 1].kind == GlslTokenKind::Identifier && tokens[i + 2].text == "(") {
+            pending_ = tokens[i + 1].text;
+        }
+    }
+
+    // Function whose body the last visited token is in, or empty
+    std::string_view current() const { return current_; }
+
+    // Whether the last visited token is a member of a struct or an
+    // interface block, and whether that is a uniform block
+    bool inAggregate() const { return aggregate_; }
+    bool inUniformBlock() const { return uniformBlock_; }
+
+private:
+    std::string_view current_;
+    std::string_view pending_;
+    int depth_ = 0;
+    bool aggregate_ = false;
+    bool uniformBlock_ = false;
+};
+
+// State of one PrecisionAnalyzer::qualify() call. The blanked source is
+// lexed once; names and scopes are views into tokens_, which outlives
+// every other member.
+class QualifyPass {
+public:
+    explicit QualifyPass(const std::string& source);
+
+    // Qualified source; counts go into report
+    std::string run(PrecisionReport& report);
+
+private:
+    enum class Storage {
+        Uniform,
+        Varying,
+        Local,
+        Parameter,
+        Function
+    };
+
+    // An expression assigned to a variable, with the function whose
+    // locals it reads (empty at global scope)
+    struct Assignment {
+        std::string_view scope;
+        GlslTokenList tokens;
+    };
+
+    struct Variable {
+        std::string_view name;
+        Storage storage = Storage::Local;
+        bool hasSourcePrecision = false;
+        Precision sourcePrecision = Precision::Medium;
+        Precision precision = Precision::Low;
+        bool seeded = false;
+        bool accumulates = false;
+        bool member = false;             // Uniform block member: read as a uniform, never rewritten
+        ArenaVector<Assignment> assignments;
+
+        // Values the variable can hold, once any assignment was evaluated
+        bool hasRange = false;
+        double low = 0.0;
+        double high = 0.0;
+    };
+
+    struct Declaration {
+        size_t typePos = 0;              // Offset of the type keyword
+        size_t qualifierPos = 0;         // Offset of an existing precision qualifier
+        size_t qualifierLength = 0;      // 0 when the source had none
+        std::string_view scope;
+        ArenaVector<std::string_view> names;
+    };
+
+    class ExpressionParser;
+
+    void collectDeclarations();
+    void collectAssignments();
+    void collectCallArguments();
+    void seedVariables();
+    void propagate();
+    std::string rewrite() const;
+
+    // Locals and parameters of scope shadow globals of the same name
+    Variable* findVariable(std::string_view scope, std::string_view name);
+    const Variable* findVariable(std::string_view scope, std::string_view name) const;
+
+    const std::string& source_;
+    ArenaString text_;                   // Source with comments and directives blanked out
+    GlslTokenList tokens_;               // Tokens of text_
+    Precision defaultPrecision_ = Precision::Medium;
+    ArenaVector<std::pair<size_t, size_t>> defaultPrecisionStatements_;
+    ArenaVector<Variable> variables_;
+    ArenaMap<std::pair<std::string_view, std::string_view>, size_t> variableIndex_;   // Keyed by (scope, name)
+    ArenaVector<Declaration> declarations_;
+
+    // Scratch for ExpressionParser, reused by every evaluation
+    SourceList rangeSources_;
+    ArenaVector<ValueRange> callArguments_;
+};
+
+// Recursive descent over one assigned expression, computing its value
+// range. Arithmetic results outside an operand's precision raise the
+// variables the operation reads, since GLSL evaluates an operation at the
+// highest precision among its operands.
+class QualifyPass::ExpressionParser {
+public:
+    ExpressionParser(QualifyPass& analyzer, const Assignment& assignment)
+        : analyzer_(analyzer),
+          sources_(analyzer.rangeSources_),
+          scope_(assignment.scope),
+          tokens_(assignment.tokens) {}
+
+    ValueRange evaluate() {
+        pos_ = 0;
+        sources_.clear();
+        ValueRange range;
+        if (!tokens_.empty() && parseConditional(range) && pos_ == tokens_.size()) {
+            return range;
+        }
+        return fallback();
+    }
+
+    // Whether evaluate() raised any variable's precision
+    bool raised() const { return raised_; }
+
+private:
+    bool peek(const char* text) const {
+        return pos_ < tokens_.size() && tokens_[pos_].text == text;
+    }
+
+    bool accept(const char* text) {
+        if (!peek(text)) return false;
+        pos_++;
+        return true;
+    }
+
+    // The operation runs at the highest precision among the variables it
+    // reads; if that cannot hold the result, raise them all
+    void raiseSources(const ValueRange& result) {
+        Precision needed = rangePrecision(result);
+        if (needed == Precision::Low || !result.hasSources()) return;
+
+        Precision operation = Precision::Low;
+        for (size_t i = result.sourcesBegin; i < result.sourcesEnd; ++i) {
+            operation = std::max(operation, analyzer_.variables_[sources_[i]].precision);
+        }
+        if (operation >= needed) return;
+
+        for (size_t i = result.sourcesBegin; i < result.sourcesEnd; ++i) {
+            Variable& variable = analyzer_.variables_[sources_[i]];
+            if (!variable.seeded && variable.precision < needed) {
+                variable.precision = needed;
+                raised_ = true;
+            }
+        }
+    }
+
+    ValueRange booleanOf(const ValueRange& a, const ValueRange& b) {
+        ValueRange result = combine(a, b, sources_);
+        result.low = 0.0;
+        result.high = 1.0;
+        result.clearSources();
+        return result;
+    }
+
+    // condition ? a : b
+    bool parseConditional(ValueRange& range) {
+        if (!parseBinary(range, 0)) return false;
+        if (!accept("?")) return true;
+
+        ValueRange whenTrue;
+        ValueRange whenFalse;
+        if (!parseConditional(whenTrue) || !accept(":") || !parseConditional(whenFalse)) return false;
+
+        Precision condition = range.precision;
+        range = hull(whenTrue, whenFalse, sources_);
+        range.precision = std::max(range.precision, condition);
+        return true;
+    }
+
+    // Binary operators from loosest to tightest binding
+    bool parseBinary(ValueRange& range, int level) {
+        static const std::vector<std::vector<const char*>> kLevels = {
+            {"||", "^^"}, {"&&"}, {"==", "!="}, {"<", ">", "<=", ">="}, {"+", "-"}, {"*", "/"}
+        };
+        if (level == static_cast<int>(kLevels.size())) return parseUnary(range);
+        if (!parseBinary(range, level + 1)) return false;
+
+        for (;;) {
+            const char* op = nullptr;
+            for (const char* candidate : kLevels[level]) {
+                if (peek(candidate)) op = candidate;
+            }
+            if (!op) return true;
+            pos_++;
+
+            ValueRange rhs;
+            if (!parseBinary(rhs, level + 1)) return false;
+
+            if (level >= 4) {
+                range = arithmetic(op, range, rhs, sources_);
+                raiseSources(range);
+            } else {
+                range = booleanOf(range, rhs);
+            }
+        }
+    }
+
+    bool parseUnary(ValueRange& range) {
+        if (accept("-")) {
+            if (!parseUnary(range)) return false;
+            std::swap(range.low, range.high);
+            range.low = -range.low;
+            range.high = -range.high;
+            return true;
+        }
+        if (accept("+")) return parseUnary(range);
+        if (accept("!")) {
+            if (!parseUnary(range)) return false;
+            range = booleanOf(range, range);
+            return true;
+        }
+        if (accept("++") || accept("--")) {
+            if (!parseUnary(range)) return false;
+            range = unboundedRange(range.precision);
+            return true;
+        }
+        return parsePostfix(range);
+    }
+
+    bool parsePostfix(ValueRange& range) {
+        if (!parsePrimary(range)) return false;
+
+        for (;;) {
+            if (accept(".")) {
+                // Swizzles and members keep the range of what they select from
+                if (pos_ >= tokens_.size() || tokens_[pos_].kind != GlslTokenKind::Identifier) return false;
+                pos_++;
+            } else if (accept("[")) {
+                ValueRange index;
+                if (!parseConditional(index) || !accept("]")) return false;
+            } else if (accept("++") || accept("--")) {
+                Precision precision = range.precision;
+                range = unboundedRange(precision);
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool parsePrimary(ValueRange& range) {
+        if (pos_ >= tokens_.size()) return false;
+        const GlslToken& token = tokens_[pos_];
+
+        if (token.kind == GlslTokenKind::Number) {
+            pos_++;
+            range = constantRange(std::strtod(token.text.c_str(), nullptr), literalPrecision(token.text));
+            return true;
+        }
+
+        if (accept("(")) {
+            return parseConditional(range) && accept(")");
+        }
+
+        if (token.kind != GlslTokenKind::Identifier) return false;
+        pos_++;
+
+        if (peek("(")) {
+            return parseCall(token.text, range);
+        }
+
+        if (isTypeKeyword(token.text)) return false;
+
+        if (token.text == "true" || token.text == "false") {
+            range = constantRange(token.text == "true" ? 1.0 : 0.0, Precision::Low);
+        } else if (token.text == "gl_FragCoord") {
+            range = unboundedRange(Precision::High);
+        } else if (const Variable* variable = analyzer_.findVariable(scope_, token.text)) {
+            range = variableRange(*variable);
+        } else {
+            // Macros, integer counters and other unknowns
+            range = unboundedRange(Precision::Medium);
+        }
+        return true;
+    }
+
+    ValueRange variableRange(const Variable& variable) {
+        // Reads before any evaluated assignment start from zero; the
+        // fixed point widens them as assignments are seen
+        ValueRange range = constantRange(0.0, variable.precision);
+        if (variable.hasRange) {
+            range.low = variable.low;
+            range.high = variable.high;
+        }
+        range.sourcesBegin = sources_.size();
+        sources_.push_back(static_cast<size_t>(&variable - analyzer_.variables_.data()));
+        range.sourcesEnd = sources_.size();
+        return range;
+    }
+
+    // Arguments of the calls being parsed, innermost last; a call pops
+    // its own when it is done
+    class CallArguments {
+    public:
+        explicit CallArguments(ArenaVector<ValueRange>& stack) : stack_(stack), base_(stack.size()) {}
+        ~CallArguments() { stack_.resize(base_); }
+
+        void push(const ValueRange& arg) { stack_.push_back(arg); }
+        size_t size() const { return stack_.size() - base_; }
+        bool empty() const { return size() == 0; }
+        const ValueRange& operator[](size_t i) const { return stack_[base_ + i]; }
+
+    private:
+        ArenaVector<ValueRange>& stack_;
+        size_t base_;
+    };
+
+    bool parseCall(std::string_view name, ValueRange& range) {
+        pos_++;
+        CallArguments args(analyzer_.callArguments_);
+        if (!accept(")")) {
+            do {
+                ValueRange arg;
+                if (!parseConditional(arg)) return false;
+                args.push(arg);
+            } while (accept(","));
+            if (!accept(")")) return false;
+        }
+
+        // Precision and sources of every argument
+        ValueRange all = unboundedRange(Precision::Low);
+        for (size_t i = 0; i < args.size(); ++i) {
+            ValueRange merged = combine(all, args[i], sources_);
+            all.precision = merged.precision;
+            all.sourcesBegin = merged.sourcesBegin;
+            all.sourcesEnd = merged.sourcesEnd;
+        }
+        range = all;
+
+        if (const BoundedFunction* bounded = findBoundedFunction(name)) {
+            range = unboundedRange(Precision::Medium);
+            range.low = bounded->low;
+            range.high = bounded->high;
+        } else if (isTypeKeyword(name)) {
+            // Constructors hold their arguments
+            if (args.empty()) return false;
+            range = args[0];
+            for (size_t i = 1; i < args.size(); ++i) range = hull(range, args[i], sources_);
+        } else if (name == "clamp" && args.size() == 3) {
+            // Result lies between the bounds
+            range.precision = std::max(args[1].precision, args[2].precision);
+            range.low = args[1].low;
+            range.high = args[2].high;
+        } else if (name == "mod" && args.size() == 2) {
+            range.precision = args[1].precision;
+            range.high = magnitude(args[1]);
+            range.low = args[1].low > 0.0 ? 0.0 : -range.high;
+        } else if (name == "mix" && args.size() == 3) {
+            range.precision = std::max(args[0].precision, args[1].precision);
+            range.low = std::min(args[0].low, args[1].low);
+            range.high = std::max(args[0].high, args[1].high);
+        } else if ((name == "min" || name == "max") && args.size() == 2) {
+            bool isMin = name == "min";
+            range.low = isMin ? std::min(args[0].low, args[1].low) : std::max(args[0].low, args[1].low);
+            range.high = isMin ? std::min(args[0].high, args[1].high) : std::max(args[0].high, args[1].high);
+        } else if (name == "abs" && args.size() == 1) {
+            range.low = 0.0;
+            range.high = magnitude(args[0]);
+        } else if ((name == "floor" || name == "ceil") && args.size() == 1) {
+            range.low = std::floor(args[0].low);
+            range.high = std::ceil(args[0].high);
+        } else if (name == "sqrt" && args.size() == 1) {
+            range.low = 0.0;
+            range.high = std::sqrt(std::max(args[0].high, 0.0));
+        } else if (const Variable* function = analyzer_.findVariable("", name)) {
+            // User functions carry their return range and precision
+            if (function->storage == Storage::Function) {
+                ValueRange result = variableRange(*function);
+                result.precision = std::max(result.precision, range.precision);
+                range = result;
+            }
+        }
+        // Other built-ins: unbounded at the precision of their arguments
+
+        if (isValueFunction(name)) {
+            range.precision = Precision::Medium;
+            range.clearSources();
+        }
+
+        if (std::isnan(range.low) || std::isnan(range.high)) {
+            range.low = -kUnbounded;
+            range.high = kUnbounded;
+        }
+        return true;
+    }
+
+    // Expressions the parser does not understand: the highest precision of
+    // anything they read, with no range information
+    ValueRange fallback() const {
+        ValueRange range = unboundedRange(Precision::Medium);
+        for (const auto& token : tokens_) {
+            if (token.kind == GlslTokenKind::Number) {
+                range.precision = std::max(range.precision, literalPrecision(token.text));
+            } else if (token.text == "gl_FragCoord") {
+                range.precision = Precision::High;
+            } else if (token.kind == GlslTokenKind::Identifier) {
+                const Variable* variable = analyzer_.findVariable(scope_, token.text);
+                if (variable) range.precision = std::max(range.precision, variable->precision);
+            }
+        }
+        return range;
+    }
+
+    QualifyPass& analyzer_;
+    SourceList& sources_;
+    std::string_view scope_;
+    const GlslTokenList& tokens_;
+    size_t pos_ = 0;
+    bool raised_ = false;
+};
+
+// Directives are blanked in place so offsets still map one-to-one onto
+// the original source
+QualifyPass::QualifyPass(const std::string& source)
+    : source_(source),
+      text_(GlslLexer::stripDirectives(source, nullptr)),
+      tokens_(GlslLexer::tokenize(text_)) {}
+
+std::string QualifyPass::run(PrecisionReport& report) {
+    collectDeclarations();
+    collectAssignments();
+    collectCallArguments();
+    seedVariables();
+    propagate();
+
+    for (const auto& variable : variables_) {
+        if (variable.storage == Storage::Function || variable.member) continue;
+
+        report.variableCount++;
+        switch (variable.precision) {
+            case Precision::High: report.highpCount++; break;
+            case Precision::Medium: report.mediumpCount++; break;
+            case Precision::Low: report.lowpCount++; break;
+        }
+
+        Precision original = variable.hasSourcePrecision ? variable.sourcePrecision : defaultPrecision_;
+        if (variable.precision < original) report.downgradedCount++;
+        else if (variable.precision > original) report.upgradedCount++;
+    }
+
+    return rewrite();
+}
+
+void QualifyPass::collectDeclarations() {
+    const GlslTokenList& tokens = tokens_;
+    FunctionScope scope;
+
+    auto declare = [this](std::string_view scopeName, std::string_view name,
+                          Storage storage) -> Variable& {
+        auto key = std::make_pair(scopeName, name);
+        auto it = variableIndex_.find(key);
+        if (it == variableIndex_.end()) {
+            Variable variable;
+            variable.name = name;
+            variable.storage = storage;
+            variableIndex_[key] = variables_.size();
+            variables_.push_back(variable);
+            return variables_.back();
+        }
+        return variables_[it->second];
+    };
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        scope.visit(tokens, i);
+        const GlslToken& token = tokens[i];
+
+        // Default precision statement: precision <qualifier> float;
+        if (token.text == "precision" && i + 3 < tokens.size() &&
+            tokens[i + 2].text == "float" && tokens[i + 3].text == ";") {
+            defaultPrecision_ = parsePrecision(tokens[i + 1].text);
+            size_t endPos = tokens[i + 3].pos + 1;
+            defaultPrecisionStatements_.emplace_back(token.pos, endPos - token.pos);
+            i += 3;
+            continue;
+        }
+
+        if (token.kind != GlslTokenKind::Identifier || !isTypeKeyword(token.text)) continue;
+        if (i + 1 >= tokens.size() || tokens[i + 1].kind != GlslTokenKind::Identifier) continue;
+
+        // Walk back over qualifiers to find the start of the declaration
+        size_t start = i;
+        Storage storage = Storage::Local;
+        Declaration declaration;
+        declaration.typePos = token.pos;
+        declaration.scope = scope.current();
+        bool hasPrecision = false;
+        Precision sourcePrecision = Precision::Medium;
+
+        while (start > 0 && tokens[start - 1].kind == GlslTokenKind::Identifier &&
+               (isPrecisionQualifier(tokens[start - 1].text) || isStorageQualifier(tokens[start - 1].text))) {
+            const GlslToken& qualifier = tokens[start - 1];
+            if (isPrecisionQualifier(qualifier.text)) {
+                hasPrecision = true;
+                sourcePrecision = parsePrecision(qualifier.text);
+                declaration.qualifierPos = qualifier.pos;
+                declaration.qualifierLength = qualifier.text.length();
+            } else if (qualifier.text == "uniform") {
+                storage = Storage::Uniform;
+            } else if (qualifier.text == "varying") {
+                storage = Storage::Varying;
+            }
+            start--;
+        }
+
+        bool forInit = start >= 2 && tokens[start - 1].text == "(" && tokens[start - 2].text == "for";
+        bool statementStart = start == 0 || tokens[start - 1].text == ";" ||
+                              tokens[start - 1].text == "{" || tokens[start - 1].text == "}";
+        if (!statementStart && !forInit) continue;
+
+        // Struct members get their precision from the declaration that uses
+        // the struct and are left alone. Uniform block members are uniforms
+        // without instance names reading them bare, so they are known for
+        // reads but keep their declared qualifiers too.
+        if (scope.inAggregate()) {
+            if (!scope.inUniformBlock() || !isFloatType(token.text)) continue;
+            for (size_t j = i + 1; j < tokens.size() && tokens[j].kind == GlslTokenKind::Identifier; j += 2) {
+                Variable& variable = declare("", tokens[j].text, Storage::Uniform);
+                variable.member = true;
+                variable.hasSourcePrecision = hasPrecision;
+                variable.sourcePrecision = sourcePrecision;
+                if (j + 1 >= tokens.size() || tokens[j + 1].text != ",") break;
+            }
+            continue;
+        }
+
+        // Function definition or prototype
+        if (i + 2 < tokens.size() && tokens[i + 2].text == "(") {
+            std::string_view name = tokens[i + 1].text;
+            size_t close = findClosingParen(tokens, i + 2, tokens.size());
+
+            if (isFloatType(token.text)) {
+                Variable& function = declare("", name, Storage::Function);
+                function.hasSourcePrecision = function.hasSourcePrecision || hasPrecision;
+                if (hasPrecision) function.sourcePrecision = std::max(function.sourcePrecision, sourcePrecision);
+                declaration.names.push_back(name);
+                declarations_.push_back(declaration);
+            }
+
+            // Parameters: [qualifiers] type name [, ...]
+            for (const auto& arg : splitArguments(tokens, i + 2, close)) {
+                Declaration parameter;
+                parameter.scope = name;
+                bool paramPrecision = false;
+                Precision paramSourcePrecision = Precision::Medium;
+
+                for (size_t p = arg.first; p < arg.second; ++p) {
+                    const GlslToken& part = tokens[p];
+                    if (isPrecisionQualifier(part.text)) {
+                        paramPrecision = true;
+                        paramSourcePrecision = parsePrecision(part.text);
+                        parameter.qualifierPos = part.pos;
+                        parameter.qualifierLength = part.text.length();
+                    } else if (isFloatType(part.text) && p + 1 < arg.second &&
+                               tokens[p + 1].kind == GlslTokenKind::Identifier) {
+                        parameter.typePos = part.pos;
+                        parameter.names.push_back(tokens[p + 1].text);
+                        break;
+                    }
+                }
+
+                if (parameter.names.empty()) continue;
+
+                Variable& variable = declare(name, parameter.names[0], Storage::Parameter);
+                variable.hasSourcePrecision = variable.hasSourcePrecision || paramPrecision;
+                if (paramPrecision) {
+                    variable.sourcePrecision = std::max(variable.sourcePrecision, paramSourcePrecision);
+                }
+                declarations_.push_back(parameter);
+            }
+
+            i = close;
+            continue;
+        }
+
+        if (!isFloatType(token.text)) continue;
+
+        // Declarator list: name [array] [= initializer] {, ...} ;
+        size_t j = i + 1;
+        while (j < tokens.size() && tokens[j].kind == GlslTokenKind::Identifier) {
+            std::string_view name = tokens[j].text;
+            Variable& variable = declare(declaration.scope, name, storage);
+            variable.hasSourcePrecision = variable.hasSourcePrecision || hasPrecision;
+            if (hasPrecision) variable.sourcePrecision = std::max(variable.sourcePrecision, sourcePrecision);
+            declaration.names.push_back(name);
+            j++;
+
+            if (j < tokens.size() && tokens[j].text == "[") {
+                while (j < tokens.size() && tokens[j].text != "]") j++;
+                j++;
+            }
+
+            if (j < tokens.size() && tokens[j].text == "=") {
+                size_t exprEnd = findExpressionEnd(tokens, j + 1);
+                // The reference may have been invalidated by declare() above
+                variables_[variableIndex_[{declaration.scope, name}]].assignments.push_back(
+                    {declaration.scope, tokenSlice(tokens, j + 1, exprEnd)});
+                j = exprEnd;
+            }
+
+            if (j < tokens.size() && tokens[j].text == ",") {
+                j++;
+                continue;
+            }
+            break;
+        }
+
+        declarations_.push_back(declaration);
+        i = j;
+    }
+}
+
+void QualifyPass::collectAssignments() {
+    const GlslTokenList& tokens = tokens_;
+    FunctionScope scope;
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        scope.visit(tokens, i);
+        const GlslToken& token = tokens[i];
+        std::string_view currentFunction = scope.current();
+
+        if (token.text == "{" || token.text == "}") continue;
+
+        if (isTypeKeyword(token.text) && i + 2 < tokens.size() &&
+            tokens[i + 1].kind == GlslTokenKind::Identifier && tokens[i + 2].text == "(") {
+            continue;
+        }
+
+        if (token.text == "return" && !currentFunction.empty()) {
+            Variable* function = findVariable("", currentFunction);
+            if (function) {
+                size_t exprEnd = findExpressionEnd(tokens, i + 1);
+                function->assignments.push_back({currentFunction, tokenSlice(tokens, i + 1, exprEnd)});
+            }
+            continue;
+        }
+
+        if (token.kind != GlslTokenKind::Identifier) continue;
+        if (i > 0 && (tokens[i - 1].text == "." || isTypeKeyword(tokens[i - 1].text))) continue;
+
+        Variable* variable = findVariable(currentFunction, token.text);
+        if (!variable) continue;
+
+        // Skip member access or indexing on the assignment target
+        size_t j = i + 1;
+        while (j < tokens.size()) {
+            if (tokens[j].text == "." && j + 1 < tokens.size()) {
+                j += 2;
+            } else if (tokens[j].text == "[") {
+                while (j < tokens.size() && tokens[j].text != "]") j++;
+                j++;
+            } else {
+                break;
+            }
+        }
+        if (j >= tokens.size()) continue;
+
+        const ArenaString& op = tokens[j].text;
+        if (op == "++" || op == "--") {
+            variable->accumulates = true;
+            continue;
+        }
+        if (op != "=" && op != "+=" && op != "-=" && op != "*=" && op != "/=") continue;
+
+        size_t exprEnd = findExpressionEnd(tokens, j + 1);
+
+        if (op != "=") {
+            // Repeated scaling grows or shrinks without bound just like a sum
+            variable->accumulates = true;
+        } else {
+            // x = x + ... and x = x * ... also accumulate
+            for (size_t k = j + 1; k < exprEnd; ++k) {
+                if (tokens[k].text == token.text && tokens[k - 1].text != ".") {
+                    for (size_t m = j + 1; m < exprEnd; ++m) {
+                        const ArenaString& t = tokens[m].text;
+                        if (t == "+" || t == "-" || t == "*" || t == "/") variable->accumulates = true;
+                    }
+                    break;
+                }
+            }
+        }
+
+        variable->assignments.push_back({currentFunction, tokenSlice(tokens, j + 1, exprEnd)});
+        i = exprEnd;
+    }
+}
+
+void QualifyPass::collectCallArguments() {
+    const GlslTokenList& tokens = tokens_;
+
+    // Map each function to its ordered parameter names
+    ArenaMap<std::string_view, ArenaVector<std::pair<std::string_view, bool>>> parameters;
+    for (size_t i = 0; i + 2 < tokens.size(); ++i) {
+        if (!isTypeKeyword(tokens[i].text) || tokens[i + 1].kind != GlslTokenKind::Identifier ||
+            tokens[i + 2].text != "(") {
+            continue;
+        }
+        if (i > 0 && tokens[i - 1].text != ";" && tokens[i - 1].text != "}" &&
+            tokens[i - 1].text != "{" && !isPrecisionQualifier(tokens[i - 1].text)) {
+            continue;
+        }
+
+        size_t close = findClosingParen(tokens, i + 2, tokens.size());
+        ArenaVector<std::pair<std::string_view, bool>> names;
+        for (const auto& arg : splitArguments(tokens, i + 2, close)) {
+            std::string_view name;
+            bool output = false;
+            for (size_t p = arg.first; p < arg.second; ++p) {
+                if (tokens[p].text == "out" || tokens[p].text == "inout") output = true;
+                if (tokens[p].kind == GlslTokenKind::Identifier && !isTypeKeyword(tokens[p].text) &&
+                    !isPrecisionQualifier(tokens[p].text) && !isStorageQualifier(tokens[p].text)) {
+                    name = tokens[p].text;
+                    break;
+                }
+            }
+            names.emplace_back(name, output);
+        }
+        parameters[std::string_view(tokens[i + 1].text)] = names;
+        i = close;
+    }
+
+    FunctionScope scope;
+    for (size_t i = 0; i + 1 < tokens.size(); ++i) {
+        scope.visit(tokens, i);
+
+        auto it = parameters.find(tokens[i].text);
+        if (it == parameters.end() || tokens[i + 1].text != "(") continue;
+        if (i > 0 && (isTypeKeyword(tokens[i - 1].text) || tokens[i - 1].text == ".")) continue;
+
+        std::string_view callee = it->first;
+        std::string_view caller = scope.current();
+        size_t close = findClosingParen(tokens, i + 1, tokens.size());
+        auto args = splitArguments(tokens, i + 1, close);
+
+        for (size_t a = 0; a < args.size() && a < it->second.size(); ++a) {
+            const auto& param = it->second[a];
+            Variable* parameter = findVariable(callee, param.first);
+            if (parameter && parameter->storage == Storage::Parameter) {
+                parameter->assignments.push_back({caller, tokenSlice(tokens, args[a].first, args[a].second)});
+            }
+
+            // out/inout parameters write back into the caller's variable
+            if (param.second && args[a].second - args[a].first >= 1) {
+                Variable* target = findVariable(caller, tokens[args[a].first].text);
+                if (target) {
+                    target->assignments.push_back(
+                        {callee, GlslTokenList{{GlslTokenKind::Identifier, ArenaString(param.first), 0}}});
+                }
+            }
+        }
+    }
+}
+
+void QualifyPass::seedVariables() {
+    for (auto& variable : variables_) {
+        switch (variable.storage) {
+            case Storage::Varying:
+                // Interpolated texture coordinates and positions
+                variable.precision = Precision::High;
+                variable.seeded = true;
+                break;
+            case Storage::Uniform:
+                variable.precision = isLargeRangeUniform(variable.name) ? Precision::High : Precision::Medium;
+                variable.seeded = true;
+                break;
+            case Storage::Parameter:
+                // Parameters without call sites keep the default
+                if (variable.assignments.empty()) {
+                    variable.precision = Precision::Medium;
+                    variable.seeded = true;
+                }
+                break;
+            default:
+                // Running sums and products overflow the lowp range
+                variable.precision = variable.accumulates ? Precision::Medium : Precision::Low;
+                break;
+        }
+
+        // Inputs and running values can hold anything
+        if (variable.seeded || variable.accumulates) {
+            variable.hasRange = true;
+            variable.low = -kUnbounded;
+            variable.high = kUnbounded;
+        }
+    }
+}
+
+void QualifyPass::propagate() {
+    // Ranges and precisions only ever grow. Every acyclic chain settles
+    // within one iteration per variable; ranges still growing after that
+    // feed back into themselves and are widened to unbounded, after which
+    // the fixed point is reached within a few more iterations.
+    const size_t widenAfter = variables_.size() + 1;
+
+    for (size_t iteration = 0;; ++iteration) {
+        bool changed = false;
+        bool widen = iteration >= widenAfter;
+
+        for (auto& variable : variables_) {
+            if (variable.seeded) continue;
+
+            for (const auto& assignment : variable.assignments) {
+                ExpressionParser parser(*this, assignment);
+                ValueRange range = parser.evaluate();
+                changed = changed || parser.raised();
+
+                if (!variable.hasRange) {
+                    variable.hasRange = true;
+                    variable.low = range.low;
+                    variable.high = range.high;
+                    changed = true;
+                } else {
+                    if (range.low < variable.low) {
+                        variable.low = widen ? -kUnbounded : range.low;
+                        changed = true;
+                    }
+                    if (range.high > variable.high) {
+                        variable.high = widen ? kUnbounded : range.high;
+                        changed = true;
+                    }
+                }
+
+                ValueRange held = constantRange(variable.low, range.precision);
+                held.high = variable.high;
+                Precision precision = std::max(range.precision, rangePrecision(held));
+                if (precision > variable.precision) {
+                    variable.precision = precision;
+                    changed = true;
+                }
+            }
+        }
+
+        if (!changed) break;
+    }
+}
+
+std::string QualifyPass::rewrite() const {
+    struct Edit {
+        size_t pos;
+        size_t length;
+        ArenaString text;
+    };
+    ArenaVector<Edit> edits;
+    const std::string& source = source_;
+
+    bool needsHighp = std::any_of(variables_.begin(), variables_.end(),
+                                  [](const Variable& v) { return !v.member && v.precision == Precision::High; });
+
+    ArenaString highpBlock;
+    if (needsHighp) {
+        highpBlock = ArenaString("\n#ifdef GL_FRAGMENT_PRECISION_HIGH\n#define ") + kHighpMacro +
+                     " highp\n#else\n#define " + kHighpMacro + " mediump\n#endif";
+    }
+
+    if (defaultPrecisionStatements_.empty()) {
+        // Insert after any leading #version/#extension directives
+        size_t insertPos = 0;
+        size_t lineStart = 0;
+        while (lineStart < source.length()) {
+            size_t lineEnd = source.find('\n', lineStart);
+            if (lineEnd == std::string::npos) lineEnd = source.length();
+            size_t first = source.find_first_not_of(" \t", lineStart);
+            if (first < lineEnd && (source.compare(first, 8, "#version") == 0 ||
+                                    source.compare(first, 10, "#extension") == 0)) {
+                insertPos = std::min(lineEnd + 1, source.length());
+            }
+            lineStart = lineEnd + 1;
+        }
+        edits.push_back({insertPos, 0, "precision mediump float;" + highpBlock + "\n"});
+    } else {
+        for (size_t s = 0; s < defaultPrecisionStatements_.size(); ++s) {
+            const auto& statement = defaultPrecisionStatements_[s];
+            ArenaString replacement = "precision mediump float;";
+            if (s == 0 && !highpBlock.empty()) {
+                replacement += highpBlock;
+                size_t next = statement.first + statement.second;
+                if (next < source.length() && source[next] != '\n') replacement += "\n";
+            }
+            edits.push_back({statement.first, statement.second, replacement});
+        }
+    }
+
+    for (const auto& declaration : declarations_) {
+        if (declaration.names.empty()) continue;
+
+        Precision precision = Precision::Low;
+        bool uniform = false;
+        for (const auto& name : declaration.names) {
+            const Variable* variable = findVariable(declaration.scope, name);
+            if (!variable) continue;
+            precision = std::max(precision, variable->precision);
+            uniform = uniform || variable->storage == Storage::Uniform;
+        }
+        // Uniforms may be shared with the vertex stage; never narrow them
+        if (uniform && precision == Precision::Low) precision = Precision::Medium;
+
+        ArenaString qualifier;
+        if (precision == Precision::High) qualifier = kHighpMacro;
+        else if (precision == Precision::Low) qualifier = "lowp";
+
+        if (declaration.qualifierLength > 0) {
+            // Replace qualifier and the whitespace before the type
+            edits.push_back({declaration.qualifierPos,
+                             declaration.typePos - declaration.qualifierPos,
+                             qualifier.empty() ? "" : qualifier + " "});
+        } else if (!qualifier.empty()) {
+            edits.push_back({declaration.typePos, 0, qualifier + " "});
+        }
+    }
+
+    std::sort(edits.begin(), edits.end(),
+              [](const Edit& a, const Edit& b) { return a.pos > b.pos; });
+
+    // Sized up front so the result is the only heap allocation
+    size_t length = source.length();
+    for (const auto& edit : edits) length += edit.text.length();
+    std::string result;
+    result.reserve(length);
+    result = source;
+    for (const auto& edit : edits) {
+        result.replace(edit.pos, edit.length, edit.text);
+    }
+    return result;
+}
+
+QualifyPass::Variable* QualifyPass::findVariable(std::string_view scope, std::string_view name) {
+    const auto& self = *this;
+    return const_cast<Variable*>(self.findVariable(scope, name));
+}
+
+const QualifyPass::Variable* QualifyPass::findVariable(std::string_view scope, std::string_view name) const {
+    if (!scope.empty()) {
+        auto local = variableIndex_.find(std::make_pair(scope, name));
+        if (local != variableIndex_.end()) return &variables_[local->second];
+    }
+    auto global = variableIndex_.find(std::make_pair(std::string_view(), name));
+    return global == variableIndex_.end() ? nullptr : &variables_[global->second];
+}
+
+} // namespace
+
+PrecisionAnalyzer::PrecisionAnalyzer() = default;
+
+PrecisionAnalyzer::~PrecisionAnalyzer() = default;
+
+std::string PrecisionAnalyzer::qualify(const std::string& source) {
+    report_ = PrecisionReport{};
+    std::string result = QualifyPass(source).run(report_);
+
+    LOGD("Precision analysis: %d variables, %d highp, %d mediump, %d lowp, %d downgraded",
+         report_.variableCount, report_.highpCount, report_.mediumpCount,
+         report_.lowpCount, report_.downgradedCount);
+    return result;
+}
+
+PrecisionReport PrecisionAnalyzer::getReport() const {
+    return report_;
+}
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+namespace Shaderlay {
+
+enum class Precision {
+    Low = 0,
+    Medium = 1,
+    High = 2
+};
+
+struct PrecisionReport {
+    int variableCount = 0;
+    int highpCount = 0;
+    int mediumpCount = 0;
+    int lowpCount = 0;
+
+    // Relative to the precision each variable had in the original source
+    int downgradedCount = 0;
+    int upgradedCount = 0;
+};
+
+// Static range/precision analysis for GLSL ES 1.00 fragment shaders.
+// Every float variable gets the lowest qualifier that still covers the
+// range its values can reach: texture coordinates, pixel-space positions
+// and accumulated phase stay highp, color math drops to mediump/lowp.
+// Value intervals are carried through arithmetic, and since an operation
+// runs at the precision of its operands, variables feeding a result
+// outside the lowp range are raised along with it.
+// All scratch state lives for one qualify() call only, so inside an
+// ArenaScope it comes from the compile arena.
+class PrecisionAnalyzer {
+public:
+    PrecisionAnalyzer();
+    ~PrecisionAnalyzer();
+
+    // Rewrite the source with per-variable precision qualifiers
+    std::string qualify(const std::string& source);
+
+    PrecisionReport getReport() const;
+
+private:
+    PrecisionReport report_;
+};
+
+} // namespace Shaderlay
\ No newline at end of file
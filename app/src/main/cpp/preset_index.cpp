@@ -0,0 +1,622 @@
+#include "preset_index.h"
+#include "slang_parser.h"
+#include "shader_archive.h"
+#include "compile_arena.h"
+#include "native_log.h"
+#include <sys/stat.h>
+#include <dirent.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <set>
+#include <utility>
+
+#define LOG_TAG "PresetIndex"
+
+namespace Shaderlay {
+
+namespace {
+
+constexpr uint32_t kIndexMagic = 0x49504c53;   // "SLPI"
+constexpr uint32_t kIndexVersion = 1;
+constexpr unsigned kMaxWorkers = 8;
+
+struct FileStat {
+    bool exists = false;
+    int64_t mtime = 0;
+    uint64_t size = 0;
+};
+
+FileStat statFile(const std::string& path) {
+    FileStat result;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        result.exists = true;
+        result.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+        result.size = static_cast<uint64_t>(st.st_size);
+    }
+    return result;
+}
+
+// FNV-1a over the file contents
+uint64_t hashFile(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return 0;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    unsigned char buffer[16 * 1024];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            hash ^= buffer[i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+
+    fclose(file);
+    return hash;
+}
+
+// Directories are identified by (device, inode) so symlink cycles and
+// links to an already visited directory are walked only once
+using DirectoryId = std::pair<dev_t, ino_t>;
+
+void collectPresets(const std::string& rootDir, const std::string& relativeDir,
+                    std::set<DirectoryId>& visited, std::vector<std::string>& presets) {
+    std::string directory = relativeDir.empty() ? rootDir : rootDir + "/" + relativeDir;
+    struct stat dirStat;
+    if (stat(directory.c_str(), &dirStat) != 0 || !visited.insert({dirStat.st_dev, dirStat.st_ino}).second) {
+        return;
+    }
+
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return;
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.') {
+            continue;
+        }
+
+        std::string relative = relativeDir.empty() ? name : relativeDir + "/" + name;
+        struct stat st;
+        if (stat((rootDir + "/" + relative).c_str(), &st) != 0) {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            collectPresets(rootDir, relative, visited, presets);
+        } else if (relative.size() > 7 && relative.compare(relative.size() - 7, 7, ".slangp") == 0) {
+            presets.push_back(relative);
+        }
+    }
+
+    closedir(dir);
+}
+
+bool sameStamp(const IndexedDependency& a, const IndexedDependency& b) {
+    return a.mtime == b.mtime && a.size == b.size && a.contentHash == b.contentHash;
+}
+
+class Writer {
+public:
+    void u8(uint8_t v) { data_.push_back(static_cast<char>(v)); }
+    void u32(uint32_t v) { raw(&v, sizeof(v)); }
+    void i32(int32_t v) { raw(&v, sizeof(v)); }
+    void u64(uint64_t v) { raw(&v, sizeof(v)); }
+    void i64(int64_t v) { raw(&v, sizeof(v)); }
+    void str(const std::string& v) {
+        u32(static_cast<uint32_t>(v.size()));
+        data_.append(v);
+    }
+    const std::string& data() const { return data_; }
+
+private:
+    void raw(const void* p, size_t n) { data_.append(static_cast<const char*>(p), n); }
+    std::string data_;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::string& data) : data_(data) {}
+
+    bool ok() const { return ok_; }
+    uint8_t u8() { uint8_t v = 0; raw(&v, sizeof(v)); return v; }
+    uint32_t u32() { uint32_t v = 0; raw(&v, sizeof(v)); return v; }
+    int32_t i32() { int32_t v = 0; raw(&v, sizeof(v)); return v; }
+    uint64_t u64() { uint64_t v = 0; raw(&v, sizeof(v)); return v; }
+    int64_t i64() { int64_t v = 0; raw(&v, sizeof(v)); return v; }
+    std::string str() {
+        uint32_t length = u32();
+        if (!ok_ || length > data_.size() - pos_) {
+            ok_ = false;
+            return "";
+        }
+        std::string v = data_.substr(pos_, length);
+        pos_ += length;
+        return v;
+    }
+    // Guard element counts against truncated or corrupt files
+    uint32_t count() {
+        uint32_t n = u32();
+        if (n > data_.size() - pos_) ok_ = false;
+        return ok_ ? n : 0;
+    }
+
+private:
+    void raw(void* p, size_t n) {
+        if (!ok_ || n > data_.size() - pos_) {
+            ok_ = false;
+            return;
+        }
+        memcpy(p, data_.data() + pos_, n);
+        pos_ += n;
+    }
+
+    const std::string& data_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace
+
+// Where presets and the files they reference are read from. Paths are
+// relative to the library root.
+class PresetSource {
+public:
+    virtual ~PresetSource() = default;
+
+    virtual std::vector<std::string> listPresets() const = 0;
+    virtual FileStat stat(const std::string& path) const = 0;
+    // Identifies the contents; 0 only for missing files
+    virtual uint64_t hash(const std::string& path) const = 0;
+    virtual bool read(const std::string& path, std::string& content) const = 0;
+};
+
+namespace {
+
+class DirectorySource : public PresetSource {
+public:
+    explicit DirectorySource(const std::string& rootDir) : rootDir_(rootDir) {}
+
+    std::vector<std::string> listPresets() const override {
+        std::vector<std::string> presets;
+        std::set<DirectoryId> visited;
+        collectPresets(rootDir_, "", visited, presets);
+        return presets;
+    }
+
+    FileStat stat(const std::string& path) const override {
+        return statFile(rootDir_ + "/" + path);
+    }
+
+    uint64_t hash(const std::string& path) const override {
+        return hashFile(rootDir_ + "/" + path);
+    }
+
+    bool read(const std::string& path, std::string& content) const override {
+        std::ifstream file(rootDir_ + "/" + path);
+        if (!file) {
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+private:
+    std::string rootDir_;
+};
+
+// Entries of a shader pack; the directory's DOS timestamp stands in for
+// the mtime and the stored CRC-32 for the content hash
+class ArchiveSource : public PresetSource {
+public:
+    explicit ArchiveSource(const ShaderArchive& archive) : archive_(archive) {}
+
+    std::vector<std::string> listPresets() const override {
+        return archive_.listEntries(".slangp");
+    }
+
+    FileStat stat(const std::string& path) const override {
+        FileStat result;
+        if (const ArchiveEntry* entry = archive_.findEntry(path)) {
+            result.exists = true;
+            result.mtime = entry->modified;
+            result.size = entry->uncompressedSize;
+        }
+        return result;
+    }
+
+    uint64_t hash(const std::string& path) const override {
+        const ArchiveEntry* entry = archive_.findEntry(path);
+        return entry ? (1ULL << 32) | entry->crc32 : 0;
+    }
+
+    bool read(const std::string& path, std::string& content) const override {
+        if (!archive_.hasEntry(path)) {
+            return false;
+        }
+        content = archive_.readText(path);
+        return true;
+    }
+
+private:
+    const ShaderArchive& archive_;
+};
+
+// Shared between workers so each dependency is hashed at most once per scan
+class DependencyCache {
+public:
+    explicit DependencyCache(const PresetSource& source) : source_(source) {}
+
+    IndexedDependency get(const std::string& path, const IndexedDependency* previous) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = cache_.find(path);
+            if (it != cache_.end()) return it->second;
+        }
+
+        IndexedDependency dependency;
+        dependency.path = path;
+        FileStat st = source_.stat(path);
+        if (st.exists) {
+            dependency.mtime = st.mtime;
+            dependency.size = st.size;
+            bool unchanged = previous && previous->mtime == st.mtime && previous->size == st.size;
+            dependency.contentHash = unchanged ? previous->contentHash : source_.hash(path);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_[path] = dependency;
+        return dependency;
+    }
+
+private:
+    const PresetSource& source_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, IndexedDependency> cache_;
+};
+
+// Names declared with #pragma parameter in a pass source
+void collectPassParameters(const std::string& source, std::vector<std::string>& parameters) {
+    std::istringstream lines(source);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        std::string pragma, keyword, name;
+        if (words >> pragma >> keyword >> name && pragma == "#pragma" && keyword == "parameter" &&
+            std::find(parameters.begin(), parameters.end(), name) == parameters.end()) {
+            parameters.push_back(name);
+        }
+    }
+}
+
+// Fill metadata and collect referenced files (relative to the root).
+// Parameters are the preset's overrides followed by those the passes
+// declare, so editing a pass changes the preset's metadata.
+bool parsePreset(const PresetSource& source, IndexedPreset& preset,
+                 std::vector<std::string>& dependencyPaths) {
+    std::string content;
+    if (!source.read(preset.path, content)) {
+        return false;
+    }
+
+    SlangParser parser;
+    try {
+        if (!parser.parseSlangPreset(content)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LOGE("Failed to parse %s: %s", preset.path.c_str(), e.what());
+        return false;
+    }
+
+    SlangPreset parsed = parser.getPreset();
+    preset.passCount = static_cast<int>(parsed.shaders.size());
+
+    for (int i = 0; i < parsed.parameterCount; ++i) {
+        preset.parameters.push_back(parsed.parameters[i].name);
+    }
+    for (const auto& texture : parsed.textures) {
+        preset.textures.push_back({texture.name, texture.path});
+        dependencyPaths.push_back(ShaderArchive::resolvePath(preset.path, texture.path));
+    }
+    for (const auto& shader : parsed.shaders) {
+        if (shader.path.empty()) {
+            continue;
+        }
+        std::string path = ShaderArchive::resolvePath(preset.path, shader.path);
+        std::string passSource;
+        if (source.read(path, passSource)) {
+            collectPassParameters(passSource, preset.parameters);
+        }
+        dependencyPaths.push_back(path);
+    }
+
+    // Chains often reuse a pass (e.g. stock.slang) several times
+    std::sort(dependencyPaths.begin(), dependencyPaths.end());
+    dependencyPaths.erase(std::unique(dependencyPaths.begin(), dependencyPaths.end()), dependencyPaths.end());
+    return true;
+}
+
+// Refreshes the dependency stamps of a previously indexed preset and
+// reports whether its metadata has to be parsed again: the preset itself
+// changed, or a file it references now has different contents. A touched
+// file with the same contents only refreshes its stamp.
+bool needsRescan(const IndexedPreset& previous, const FileStat& st, DependencyCache& cache,
+                 std::vector<IndexedDependency>& dependencies) {
+    if (previous.mtime != st.mtime || previous.size != st.size) {
+        return true;
+    }
+
+    bool stale = false;
+    dependencies.clear();
+    for (const auto& old : previous.dependencies) {
+        dependencies.push_back(cache.get(old.path, &old));
+        if (dependencies.back().contentHash != old.contentHash) {
+            stale = true;
+        }
+    }
+    return stale;
+}
+
+} // namespace
+
+PresetIndex::PresetIndex() = default;
+
+PresetIndex::~PresetIndex() = default;
+
+bool PresetIndex::load(const std::string& indexPath) {
+    std::ifstream file(indexPath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string data = buffer.str();
+
+    Reader reader(data);
+    if (reader.u32() != kIndexMagic || reader.u32() != kIndexVersion) {
+        LOGW("Preset index has unknown format, ignoring");
+        return false;
+    }
+
+    std::string rootDir = reader.str();
+    std::vector<IndexedPreset> presets(reader.count());
+
+    for (auto& preset : presets) {
+        preset.path = reader.str();
+        preset.mtime = reader.i64();
+        preset.size = reader.u64();
+        preset.valid = reader.u8() != 0;
+        preset.passCount = reader.i32();
+
+        preset.parameters.resize(reader.count());
+        for (auto& parameter : preset.parameters) {
+            parameter = reader.str();
+        }
+
+        preset.textures.resize(reader.count());
+        for (auto& texture : preset.textures) {
+            texture.name = reader.str();
+            texture.path = reader.str();
+        }
+
+        preset.dependencies.resize(reader.count());
+        for (auto& dependency : preset.dependencies) {
+            dependency.path = reader.str();
+            dependency.mtime = reader.i64();
+            dependency.size = reader.u64();
+            dependency.contentHash = reader.u64();
+        }
+
+        if (!reader.ok()) break;
+    }
+
+    if (!reader.ok()) {
+        LOGW("Preset index is truncated, ignoring");
+        return false;
+    }
+
+    rootDir_ = rootDir;
+    presets_ = std::move(presets);
+    rebuildLookup();
+
+    LOGD("Loaded preset index with %zu presets", presets_.size());
+    return true;
+}
+
+bool PresetIndex::save(const std::string& indexPath) const {
+    Writer writer;
+    writer.u32(kIndexMagic);
+    writer.u32(kIndexVersion);
+    writer.str(rootDir_);
+    writer.u32(static_cast<uint32_t>(presets_.size()));
+
+    for (const auto& preset : presets_) {
+        writer.str(preset.path);
+        writer.i64(preset.mtime);
+        writer.u64(preset.size);
+        writer.u8(preset.valid ? 1 : 0);
+        writer.i32(preset.passCount);
+
+        writer.u32(static_cast<uint32_t>(preset.parameters.size()));
+        for (const auto& parameter : preset.parameters) {
+            writer.str(parameter);
+        }
+
+        writer.u32(static_cast<uint32_t>(preset.textures.size()));
+        for (const auto& texture : preset.textures) {
+            writer.str(texture.name);
+            writer.str(texture.path);
+        }
+
+        writer.u32(static_cast<uint32_t>(preset.dependencies.size()));
+        for (const auto& dependency : preset.dependencies) {
+            writer.str(dependency.path);
+            writer.i64(dependency.mtime);
+            writer.u64(dependency.size);
+            writer.u64(dependency.contentHash);
+        }
+    }
+
+    // Write-then-rename so a crash never leaves a half-written index
+    std::string tempPath = indexPath + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        LOGE("Failed to write preset index: %s", tempPath.c_str());
+        return false;
+    }
+
+    const std::string& data = writer.data();
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = (fclose(file) == 0) && written;
+
+    if (!written || rename(tempPath.c_str(), indexPath.c_str()) != 0) {
+        LOGE("Failed to commit preset index: %s", indexPath.c_str());
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+IndexStats PresetIndex::update(const std::string& rootDir, unsigned threadCount) {
+    return updateFrom(rootDir, DirectorySource(rootDir), threadCount);
+}
+
+IndexStats PresetIndex::updateArchive(const ShaderArchive& archive, const std::string& archiveKey,
+                                      unsigned threadCount) {
+    return updateFrom(archiveKey, ArchiveSource(archive), threadCount);
+}
+
+IndexStats PresetIndex::updateFrom(const std::string& rootKey, const PresetSource& source,
+                                   unsigned threadCount) {
+    IndexStats stats;
+
+    // Relative paths are only comparable within the same library
+    if (rootKey != rootDir_) {
+        presets_.clear();
+        lookup_.clear();
+        rootDir_ = rootKey;
+        stats.dirty = true;
+    }
+
+    std::vector<std::string> paths = source.listPresets();
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<IndexedPreset> updated(paths.size());
+    DependencyCache dependencyCache(source);
+    std::atomic<size_t> next{0};
+    std::atomic<int> reparsed{0};
+    std::atomic<bool> stampsChanged{false};
+
+    auto worker = [&]() {
+        // Parser scratch lives in the worker's arena, released per preset
+        CompileArena arena;
+
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            IndexedPreset& preset = updated[i];
+            preset.path = paths[i];
+
+            FileStat st = source.stat(preset.path);
+            const IndexedPreset* previous = findPreset(preset.path);
+
+            std::vector<IndexedDependency> refreshed;
+            if (previous && !needsRescan(*previous, st, dependencyCache, refreshed)) {
+                preset = *previous;
+                for (size_t d = 0; d < refreshed.size(); ++d) {
+                    if (!sameStamp(refreshed[d], preset.dependencies[d])) {
+                        stampsChanged = true;
+                    }
+                }
+                preset.dependencies = std::move(refreshed);
+                continue;
+            }
+
+            reparsed++;
+            preset.mtime = st.mtime;
+            preset.size = st.size;
+
+            std::vector<std::string> dependencyPaths;
+            {
+                ArenaScope scope(arena);
+                preset.valid = parsePreset(source, preset, dependencyPaths);
+            }
+            arena.reset();
+
+            for (const auto& path : dependencyPaths) {
+                const IndexedDependency* old = nullptr;
+                if (previous) {
+                    for (const auto& candidate : previous->dependencies) {
+                        if (candidate.path == path) old = &candidate;
+                    }
+                }
+                preset.dependencies.push_back(dependencyCache.get(path, old));
+            }
+        }
+    };
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::min(std::thread::hardware_concurrency(), kMaxWorkers));
+    }
+    threadCount = std::min<unsigned>(threadCount, std::max<size_t>(1, paths.size()));
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threadCount; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    for (const auto& preset : presets_) {
+        if (!std::binary_search(paths.begin(), paths.end(), preset.path)) {
+            stats.removed++;
+        }
+    }
+
+    stats.scanned = static_cast<int>(paths.size());
+    stats.reparsed = reparsed;
+    stats.reused = stats.scanned - stats.reparsed;
+    stats.dirty = stats.dirty || stats.reparsed > 0 || stats.removed > 0 || stampsChanged;
+
+    presets_ = std::move(updated);
+    rebuildLookup();
+
+    LOGI("Indexed %d presets (%d reparsed, %d reused, %d removed)",
+         stats.scanned, stats.reparsed, stats.reused, stats.removed);
+    return stats;
+}
+
+const std::vector<IndexedPreset>& PresetIndex::getPresets() const {
+    return presets_;
+}
+
+const IndexedPreset* PresetIndex::findPreset(const std::string& path) const {
+    auto it = lookup_.find(path);
+    return it == lookup_.end() ? nullptr : &presets_[it->second];
+}
+
+void PresetIndex::rebuildLookup() {
+    lookup_.clear();
+    lookup_.reserve(presets_.size());
+    for (size_t i = 0; i < presets_.size(); ++i) {
+        lookup_[presets_[i].path] = i;
+    }
+}
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Shaderlay {
+
+class ShaderArchive;
+class PresetSource;
+
+struct IndexedDependency {
+    std::string path;                 // Relative to the library root
+    int64_t mtime = 0;
+    uint64_t size = 0;
+    uint64_t contentHash = 0;         // 0 if the file is missing
+};
+
+struct IndexedTexture {
+    std::string name;
+    std::string path;
+};
+
+struct IndexedPreset {
+    std::string path;                 // Relative to the library root
+    int64_t mtime = 0;
+    uint64_t size = 0;
+    bool valid = false;
+    int passCount = 0;
+    std::vector<std::string> parameters;
+    std::vector<IndexedTexture> textures;
+    std::vector<IndexedDependency> dependencies;
+};
+
+struct IndexStats {
+    int scanned = 0;
+    int reparsed = 0;
+    int reused = 0;
+    int removed = 0;
+    bool dirty = false;               // Index differs from what was loaded or last saved
+};
+
+// Persistent metadata index over a slang-shaders library, either a
+// directory tree or a shader pack. Presets are reused as long as neither
+// their own stamp nor the contents of a file they reference changed;
+// everything else is re-parsed with SlangParser on a worker pool.
+class PresetIndex {
+public:
+    PresetIndex();
+    ~PresetIndex();
+
+    bool load(const std::string& indexPath);
+    bool save(const std::string& indexPath) const;
+
+    // Rescan rootDir, re-parsing only new or modified presets. Save the
+    // index whenever the returned stats are dirty.
+    IndexStats update(const std::string& rootDir, unsigned threadCount = 0);
+    // Same over the presets of an open shader pack; archiveKey identifies
+    // the pack across runs (e.g. its document URI)
+    IndexStats updateArchive(const ShaderArchive& archive, const std::string& archiveKey,
+                             unsigned threadCount = 0);
+
+    const std::vector<IndexedPreset>& getPresets() const;
+    const IndexedPreset* findPreset(const std::string& path) const;
+
+private:
+    IndexStats updateFrom(const std::string& rootKey, const PresetSource& source, unsigned threadCount);
+    void rebuildLookup();
+
+    std::string rootDir_;
+    std::vector<IndexedPreset> presets_;
+    std::unordered_map<std::string, size_t> lookup_;
+};
+
+} // namespace Shaderlay
\ No newline at end of file
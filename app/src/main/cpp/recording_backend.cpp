@@ -0,0 +1,249 @@
+#include "recording_backend.h"
+#include "native_log.h"
+#include <algorithm>
+
+#define LOG_TAG "RecordingBackend"
+
+namespace Shaderlay {
+
+RecordingBackend::RecordingBackend(bool keepCommands)
+    : keepCommands_(keepCommands) {
+}
+
+RecordingBackend::~RecordingBackend() {
+    if (liveResources_ != 0) {
+        LOGW("%d resources were not destroyed", liveResources_);
+    }
+}
+
+uint32_t RecordingBackend::createProgram(const std::string& vertexSource, const std::string& fragmentSource) {
+    if (vertexSource.empty() || fragmentSource.empty()) {
+        return 0;
+    }
+    liveResources_++;
+    return nextHandle_++;
+}
+
+void RecordingBackend::destroyProgram(uint32_t program) {
+    if (program != 0) liveResources_--;
+    if (boundProgram_.matches(program)) boundProgram_.invalidate();
+}
+
+int RecordingBackend::uniformLocation(uint32_t program, const char* name) {
+    // Every uniform "exists" so the executor's full per-pass work is measured
+    return static_cast<int>(nextHandle_++);
+}
+
+bool RecordingBackend::createRenderTarget(int width, int height, bool filterLinear, RenderTarget& target) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    target.framebuffer = nextHandle_++;
+    target.texture = nextHandle_++;
+    target.width = width;
+    target.height = height;
+    target.filterLinear = filterLinear;
+    liveResources_++;
+    liveTargets_.push_back(target);
+    return true;
+}
+
+void RecordingBackend::destroyRenderTarget(const RenderTarget& target) {
+    liveResources_--;
+    liveTargets_.erase(std::remove_if(liveTargets_.begin(), liveTargets_.end(),
+                                      [&](const RenderTarget& live) {
+                                          return live.framebuffer == target.framebuffer;
+                                      }),
+                       liveTargets_.end());
+}
+
+uint32_t RecordingBackend::createQuad() {
+    liveResources_++;
+    return nextHandle_++;
+}
+
+void RecordingBackend::destroyQuad(uint32_t quad) {
+    liveResources_--;
+}
+
+uint32_t RecordingBackend::createTexture(int width, int height, const uint8_t* pixels, bool filterLinear) {
+    if (width <= 0 || height <= 0 || pixels == nullptr) {
+        return 0;
+    }
+    liveResources_++;
+    return nextHandle_++;
+}
+
+void RecordingBackend::destroyTexture(uint32_t texture) {
+    if (texture != 0) liveResources_--;
+    for (auto& bound : boundTextures_) {
+        if (bound.matches(texture)) bound.invalidate();
+    }
+}
+
+void RecordingBackend::beginFrame() {
+    frameStart_ = counters_;
+    if (keepCommands_) {
+        commands_.clear();
+    }
+
+    // Other code shares a real context between frames
+    boundProgram_.invalidate();
+    boundFramebuffer_.invalidate();
+    for (auto& texture : boundTextures_) {
+        texture.invalidate();
+    }
+    blending_.invalidate();
+}
+
+void RecordingBackend::bindFramebuffer(uint32_t framebuffer, int width, int height) {
+    RecordedCall call;
+    call.command = RecordedCommand::BindFramebuffer;
+    call.handle = framebuffer;
+    call.width = width;
+    call.height = height;
+    stateChange(call, !boundFramebuffer_.matches(framebuffer));
+    boundFramebuffer_.set(framebuffer);
+}
+
+void RecordingBackend::setBlending(bool enabled) {
+    RecordedCall call;
+    call.command = RecordedCommand::SetBlending;
+    call.handle = enabled ? 1 : 0;
+    stateChange(call, !blending_.matches(enabled));
+    blending_.set(enabled);
+}
+
+void RecordingBackend::useProgram(uint32_t program) {
+    RecordedCall call;
+    call.command = RecordedCommand::UseProgram;
+    call.handle = program;
+    stateChange(call, !boundProgram_.matches(program));
+    boundProgram_.set(program);
+}
+
+void RecordingBackend::bindTexture(int unit, uint32_t texture) {
+    if (unit < 0 || unit >= kMaxTextureUnits) {
+        return;
+    }
+
+    RecordedCall call;
+    call.command = RecordedCommand::BindTexture;
+    call.handle = texture;
+    call.slot = unit;
+    stateChange(call, !boundTextures_[unit].matches(texture));
+    boundTextures_[unit].set(texture);
+}
+
+void RecordingBackend::bindQuad(uint32_t quad) {
+    RecordedCall call;
+    call.command = RecordedCommand::BindQuad;
+    call.handle = quad;
+    stateChange(call, true);
+}
+
+void RecordingBackend::setUniform1i(int location, int value) {
+    float converted = static_cast<float>(value);
+    uniform(location, &converted, 1);
+}
+
+void RecordingBackend::setUniform1f(int location, float value) {
+    uniform(location, &value, 1);
+}
+
+void RecordingBackend::setUniform2f(int location, float x, float y) {
+    const float values[] = {x, y};
+    uniform(location, values, 2);
+}
+
+void RecordingBackend::setUniform4f(int location, float x, float y, float z, float w) {
+    const float values[] = {x, y, z, w};
+    uniform(location, values, 4);
+}
+
+void RecordingBackend::setUniformMatrix4(int location, const float* matrix) {
+    uniform(location, matrix, 16);
+}
+
+void RecordingBackend::clear() {
+    RecordedCall call;
+    call.command = RecordedCommand::Clear;
+    record(call);
+}
+
+void RecordingBackend::drawQuad() {
+    counters_.drawCalls++;
+    RecordedCall call;
+    call.command = RecordedCommand::Draw;
+    record(call);
+}
+
+void RecordingBackend::endFrame() {
+    counters_.frames++;
+
+    lastFrame_.frames = 1;
+    lastFrame_.drawCalls = counters_.drawCalls - frameStart_.drawCalls;
+    lastFrame_.stateChanges = counters_.stateChanges - frameStart_.stateChanges;
+    lastFrame_.uniformUpdates = counters_.uniformUpdates - frameStart_.uniformUpdates;
+    lastFrame_.redundantCalls = counters_.redundantCalls - frameStart_.redundantCalls;
+}
+
+RecordingCounters RecordingBackend::getCounters() const {
+    return counters_;
+}
+
+RecordingCounters RecordingBackend::getLastFrameCounters() const {
+    return lastFrame_;
+}
+
+const std::vector<RecordedCall>& RecordingBackend::getCommands() const {
+    return commands_;
+}
+
+const std::vector<RenderTarget>& RecordingBackend::getLiveTargets() const {
+    return liveTargets_;
+}
+
+int RecordingBackend::getLiveResources() const {
+    return liveResources_;
+}
+
+void RecordingBackend::resetCounters() {
+    counters_ = RecordingCounters{};
+    frameStart_ = RecordingCounters{};
+    lastFrame_ = RecordingCounters{};
+    commands_.clear();
+}
+
+void RecordingBackend::record(const RecordedCall& call) {
+    if (keepCommands_) {
+        commands_.push_back(call);
+    }
+}
+
+void RecordingBackend::stateChange(RecordedCall call, bool changed) {
+    if (changed) {
+        counters_.stateChanges++;
+    } else {
+        counters_.redundantCalls++;
+    }
+    call.changedState = changed;
+    record(call);
+}
+
+void RecordingBackend::uniform(int location, const float* values, int count) {
+    counters_.uniformUpdates++;
+    if (!keepCommands_) {
+        return;
+    }
+
+    RecordedCall call;
+    call.command = RecordedCommand::SetUniform;
+    call.slot = location;
+    call.valueCount = count;
+    std::copy(values, values + count, call.values);
+    commands_.push_back(call);
+}
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "render_backend.h"
+#include <vector>
+
+namespace Shaderlay {
+
+enum class RecordedCommand {
+    BindFramebuffer,
+    SetBlending,
+    UseProgram,
+    BindTexture,
+    BindQuad,
+    SetUniform,
+    Clear,
+    Draw
+};
+
+// One call with its arguments; fields a command does not take stay zero
+struct RecordedCall {
+    RecordedCommand command = RecordedCommand::Draw;
+    uint32_t handle = 0;        // Framebuffer, program, texture or quad; 1/0 for blending
+    int slot = 0;               // Texture unit or uniform location
+    int width = 0;              // Viewport of a framebuffer bind
+    int height = 0;
+    int valueCount = 0;         // Uniform components in values; 1i values are stored as floats
+    float values[16] = {};
+    bool changedState = true;   // False for binds that matched the tracked state
+};
+
+struct RecordingCounters {
+    uint64_t frames = 0;
+    uint64_t drawCalls = 0;
+    uint64_t stateChanges = 0;      // Framebuffer, blend, program, texture and quad binds
+    uint64_t uniformUpdates = 0;
+    uint64_t redundantCalls = 0;    // Binds that would not have changed state
+};
+
+// Backend without a GPU. Hands out fake handles, counts what a frame
+// would submit and optionally keeps the calls with their arguments, so
+// per-frame CPU overhead, draw counts and binding order can be checked
+// headless. State is tracked like GlesBackend tracks it: unknown at the
+// start of every frame.
+class RecordingBackend : public RenderBackend {
+public:
+    explicit RecordingBackend(bool keepCommands = false);
+    ~RecordingBackend() override;
+
+    uint32_t createProgram(const std::string& vertexSource, const std::string& fragmentSource) override;
+    void destroyProgram(uint32_t program) override;
+    int uniformLocation(uint32_t program, const char* name) override;
+    bool createRenderTarget(int width, int height, bool filterLinear, RenderTarget& target) override;
+    void destroyRenderTarget(const RenderTarget& target) override;
+    uint32_t createQuad() override;
+    void destroyQuad(uint32_t quad) override;
+    uint32_t createTexture(int width, int height, const uint8_t* pixels, bool filterLinear) override;
+    void destroyTexture(uint32_t texture) override;
+
+    void beginFrame() override;
+    void bindFramebuffer(uint32_t framebuffer, int width, int height) override;
+    void setBlending(bool enabled) override;
+    void useProgram(uint32_t program) override;
+    void bindTexture(int unit, uint32_t texture) override;
+    void bindQuad(uint32_t quad) override;
+    void setUniform1i(int location, int value) override;
+    void setUniform1f(int location, float value) override;
+    void setUniform2f(int location, float x, float y) override;
+    void setUniform4f(int location, float x, float y, float z, float w) override;
+    void setUniformMatrix4(int location, const float* matrix) override;
+    void clear() override;
+    void drawQuad() override;
+    void endFrame() override;
+
+    RecordingCounters getCounters() const;
+    // Counters for the most recent completed frame only
+    RecordingCounters getLastFrameCounters() const;
+    // Calls of the current or most recent frame, when keeping commands
+    const std::vector<RecordedCall>& getCommands() const;
+    // Render targets created and not yet destroyed, oldest first
+    const std::vector<RenderTarget>& getLiveTargets() const;
+    int getLiveResources() const;
+    void resetCounters();
+
+private:
+    static constexpr int kMaxTextureUnits = 8;
+
+    void record(const RecordedCall& call);
+    void stateChange(RecordedCall call, bool changed);
+    void uniform(int location, const float* values, int count);
+
+    bool keepCommands_;
+    uint32_t nextHandle_ = 1;
+    int liveResources_ = 0;
+
+    CachedState<uint32_t> boundProgram_;
+    CachedState<uint32_t> boundFramebuffer_;
+    CachedState<uint32_t> boundTextures_[kMaxTextureUnits];
+    CachedState<bool> blending_;
+
+    RecordingCounters counters_;
+    RecordingCounters frameStart_;
+    RecordingCounters lastFrame_;
+    std::vector<RecordedCall> commands_;
+    std::vector<RenderTarget> liveTargets_;
+};
+
+} // namespace Shaderlay
\ No newline at end of file
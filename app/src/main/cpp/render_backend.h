@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <utility>
+
+namespace Shaderlay {
+
+// Attribute slots bound before linking so every program shares one
+// vertex layout and the quad only has to be bound once per frame
+constexpr int kPositionAttribute = 0;
+constexpr int kTexCoordAttribute = 1;
+
+struct RenderTarget {
+    uint32_t framebuffer = 0;
+    uint32_t texture = 0;
+    int width = 0;
+    int height = 0;
+    bool filterLinear = true;     // Sampling filter of the attached texture
+};
+
+// Last value a backend set for one piece of pipeline state. Starts out
+// unknown, so the first set always goes through whatever the value.
+template <typename T>
+class CachedState {
+public:
+    // Whether value is known to be in place already
+    bool matches(const T& value) const { return known_ && value_ == value; }
+    void set(const T& value) {
+        value_ = value;
+        known_ = true;
+    }
+    void invalidate() { known_ = false; }
+
+private:
+    T value_{};
+    bool known_ = false;
+};
+
+// Minimal command surface the frame executor needs. Handles are plain
+// integers so a backend without a GPU can hand out its own.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    // Resources, created when a chain is built
+    virtual uint32_t createProgram(const std::string& vertexSource, const std::string& fragmentSource) = 0;
+    virtual void destroyProgram(uint32_t program) = 0;
+    virtual int uniformLocation(uint32_t program, const char* name) = 0;
+    virtual bool createRenderTarget(int width, int height, bool filterLinear, RenderTarget& target) = 0;
+    virtual void destroyRenderTarget(const RenderTarget& target) = 0;
+    virtual uint32_t createQuad() = 0;
+    virtual void destroyQuad(uint32_t quad) = 0;
+    // Immutable sampled texture from tightly packed RGBA8 rows; 0 on failure
+    virtual uint32_t createTexture(int width, int height, const uint8_t* pixels, bool filterLinear) = 0;
+    virtual void destroyTexture(uint32_t texture) = 0;
+
+    // Per-frame commands. Backends may drop calls that would not change state.
+    virtual void beginFrame() = 0;
+    virtual void bindFramebuffer(uint32_t framebuffer, int width, int height) = 0;
+    virtual void setBlending(bool enabled) = 0;
+    virtual void useProgram(uint32_t program) = 0;
+    virtual void bindTexture(int unit, uint32_t texture) = 0;
+    virtual void bindQuad(uint32_t quad) = 0;
+    virtual void setUniform1i(int location, int value) = 0;
+    virtual void setUniform1f(int location, float value) = 0;
+    virtual void setUniform2f(int location, float x, float y) = 0;
+    virtual void setUniform4f(int location, float x, float y, float z, float w) = 0;
+    virtual void setUniformMatrix4(int location, const float* matrix) = 0;
+    virtual void clear() = 0;
+    virtual void drawQuad() = 0;
+    virtual void endFrame() = 0;
+};
+
+} // namespace Shaderlay
\ No newline at end of file
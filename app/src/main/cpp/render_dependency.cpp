@@ -0,0 +1,247 @@
+#include "render_dependency.h"
+#include "glsl_lexer.h"
+#include "native_log.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#define LOG_TAG "RenderDependency"
+
+namespace Shaderlay {
+
+namespace {
+
+// Identifier tokens in order, without literals and symbols. The views
+// point into tokens.
+ArenaVector<std::string_view> identifiers(const GlslTokenList& tokens) {
+    ArenaVector<std::string_view> result;
+    for (const auto& token : tokens) {
+        if (token.kind == GlslTokenKind::Identifier) result.push_back(token.text);
+    }
+    return result;
+}
+
+bool sameLower(char c, char lower) {
+    return std::tolower(static_cast<unsigned char>(c)) == lower;
+}
+
+bool equalsLower(std::string_view text, std::string_view lower) {
+    return std::equal(text.begin(), text.end(), lower.begin(), lower.end(), sameLower);
+}
+
+bool isTimeIdentifier(std::string_view name) {
+    std::string_view time = "time";
+    return std::search(name.begin(), name.end(), time.begin(), time.end(), sameLower) != name.end() ||
+           equalsLower(name, "framecount") || equalsLower(name, "framedirection");
+}
+
+bool isFeedbackIdentifier(std::string_view name) {
+    return name.compare(0, 15, "OriginalHistory") == 0 ||
+           (name.length() >= 8 && name.compare(name.length() - 8, 8, "Feedback") == 0);
+}
+
+bool isSamplingFunction(std::string_view name) {
+    return name == "texture" || name == "texture2D" || name == "texture2DProj" ||
+           name == "texture2DLod" || name == "textureLod" || name == "texelFetch" ||
+           name == "textureCube";
+}
+
+bool isZeroLiteral(std::string_view text) {
+    size_t start = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+    if (start == std::string_view::npos) return false;
+
+    ArenaString literal(text.substr(start, end - start + 1));
+    if (literal.empty() || !(std::isdigit(static_cast<unsigned char>(literal[0])) || literal[0] == '.')) {
+        return false;
+    }
+
+    char* parsed = nullptr;
+    double value = std::strtod(literal.c_str(), &parsed);
+    return value == 0.0 && parsed && (*parsed == '\0' || *parsed == 'f' || *parsed == 'F');
+}
+
+// Split "a, f(b, c), d" at top-level commas
+ArenaVector<std::string_view> splitTopLevel(std::string_view text) {
+    ArenaVector<std::string_view> parts;
+    int depth = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < text.length(); ++i) {
+        if (text[i] == '(') depth++;
+        else if (text[i] == ')') depth--;
+        else if (text[i] == ',' && depth == 0) {
+            parts.push_back(text.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    parts.push_back(text.substr(start));
+    return parts;
+}
+
+} // namespace
+
+RenderDependencyAnalyzer::RenderDependencyAnalyzer() = default;
+
+RenderDependencyAnalyzer::~RenderDependencyAnalyzer() = default;
+
+PassDependency RenderDependencyAnalyzer::analyzePass(const std::string& fragmentSource) {
+    PassDependency result;
+
+    // .slang files carry both stages; only the fragment stage is read.
+    // Directives such as #pragma parameter are not reads.
+    GlslDirectiveList directives;
+    ArenaString text = GlslLexer::stripDirectives(GlslLexer::fragmentStage(fragmentSource), &directives);
+
+    // Separate function bodies (reads) from global declarations. A body is
+    // a top-level '{' that follows ')', which excludes uniform blocks.
+    ArenaString bodies;
+    ArenaString globals;
+    bodies.reserve(text.length());
+    globals.reserve(text.length());
+    int depth = 0;
+    bool inFunction = false;
+    char lastSignificant = '\0';
+
+    for (char c : text) {
+        if (c == '{') {
+            if (depth == 0) inFunction = (lastSignificant == ')');
+            depth++;
+        } else if (c == '}') {
+            depth--;
+            if (depth == 0 && inFunction) {
+                inFunction = false;
+                bodies += "\n";
+                lastSignificant = c;
+                continue;
+            }
+        }
+
+        if (inFunction) bodies += c;
+        else globals += c;
+
+        if (!std::isspace(static_cast<unsigned char>(c))) lastSignificant = c;
+    }
+
+    // Global inputs and outputs: "varying vec2 v;" or "layout(location = 0) in vec2 v;"
+    ArenaVector<ArenaString> positionInputs;
+    ArenaVector<ArenaString> outputs;
+    outputs.emplace_back("gl_FragColor");
+    size_t statementStart = 0;
+    for (size_t i = 0; i <= globals.length(); ++i) {
+        if (i < globals.length() && globals[i] != ';') continue;
+
+        GlslTokenList statement = GlslLexer::tokenize(globals, statementStart, i);
+        ArenaVector<std::string_view> words = identifiers(statement);
+        statementStart = i + 1;
+        if (words.empty()) continue;
+
+        bool input = std::find(words.begin(), words.end(), "varying") != words.end() ||
+                     std::find(words.begin(), words.end(), "in") != words.end();
+        bool output = std::find(words.begin(), words.end(), "out") != words.end();
+        if (input) positionInputs.emplace_back(words.back());
+        if (output) outputs.emplace_back(words.back());
+    }
+
+    // Expand macros so reads hidden behind TEX0/COMPAT_TEXTURE count
+    GlslMacroTable macros = GlslLexer::collectMacros(directives);
+    GlslTokenList reads = GlslLexer::expandMacros(GlslLexer::tokenize(bodies), macros);
+    for (std::string_view name : identifiers(reads)) {
+        if (isTimeIdentifier(name)) result.readsTime = true;
+        if (isFeedbackIdentifier(name)) result.samplesFeedback = true;
+        if (isSamplingFunction(name)) result.samplesTextures = true;
+        if (name == "gl_FragCoord" ||
+            std::find(positionInputs.begin(), positionInputs.end(), name) != positionInputs.end()) {
+            result.readsPosition = true;
+        }
+    }
+
+    if (result.readsTime || result.samplesFeedback) {
+        result.dependency = OutputDependency::TimeDependent;
+    } else if (isOutputTransparent(bodies, outputs)) {
+        result.dependency = OutputDependency::Transparent;
+    } else if (result.readsPosition || result.samplesTextures) {
+        result.dependency = OutputDependency::ResolutionOnly;
+    } else {
+        result.dependency = OutputDependency::Constant;
+    }
+
+    return result;
+}
+
+OutputDependency RenderDependencyAnalyzer::analyzePreset(const std::vector<PassDependency>& passes) {
+    if (passes.empty()) {
+        return OutputDependency::Transparent;
+    }
+
+    OutputDependency chain = OutputDependency::Constant;
+    for (const auto& pass : passes) {
+        OutputDependency upstream = chain;
+        chain = pass.dependency;
+
+        // A transparent final pass hides everything before it; otherwise
+        // sampling the previous pass pulls in its dependency
+        if (pass.samplesTextures && pass.dependency != OutputDependency::Transparent) {
+            chain = std::max(chain, std::max(upstream, OutputDependency::Constant));
+        }
+    }
+
+    LOGD("Preset output dependency: %d over %zu passes", static_cast<int>(chain), passes.size());
+    return chain;
+}
+
+bool RenderDependencyAnalyzer::isOutputTransparent(std::string_view body,
+                                                   const ArenaVector<ArenaString>& outputs) {
+    bool sawWrite = false;
+
+    for (const auto& output : outputs) {
+        size_t pos = 0;
+        while ((pos = body.find(output, pos)) != std::string_view::npos) {
+            size_t after = pos + output.length();
+            bool wholeWord = (pos == 0 || !GlslLexer::isIdentifierChar(body[pos - 1])) &&
+                             (after >= body.length() || !GlslLexer::isIdentifierChar(body[after]));
+            pos = after;
+            if (!wholeWord) continue;
+
+            size_t next = body.find_first_not_of(" \t\r\n", after);
+            if (next == std::string_view::npos) continue;
+
+            // Partial writes (swizzles, compound ops) are not provably zero
+            if (body[next] == '.' || body[next] == '[') return false;
+            if (body[next] != '=') {
+                if (next + 1 < body.length() && body[next + 1] == '=' &&
+                    std::string_view("+-*/").find(body[next]) != std::string_view::npos) {
+                    return false;
+                }
+                continue;
+            }
+            if (next + 1 < body.length() && body[next + 1] == '=') continue;
+
+            size_t end = body.find(';', next);
+            std::string_view expression =
+                body.substr(next + 1, end == std::string_view::npos ? std::string_view::npos : end - next - 1);
+            size_t first = expression.find_first_not_of(" \t\r\n");
+            size_t last = expression.find_last_not_of(" \t\r\n");
+            if (first == std::string_view::npos) return false;
+            expression = expression.substr(first, last - first + 1);
+
+            // Only a direct vec4(..., 0.0) constructor is accepted
+            if (expression.compare(0, 4, "vec4") != 0 || expression.back() != ')') return false;
+            size_t open = expression.find('(');
+            std::string_view inner = expression.substr(open + 1, expression.length() - open - 2);
+            int depth = 0;
+            for (char c : inner) {
+                if (c == '(') depth++;
+                else if (c == ')' && --depth < 0) return false;
+            }
+
+            ArenaVector<std::string_view> args = splitTopLevel(inner);
+            if (!isZeroLiteral(args.back())) return false;
+
+            sawWrite = true;
+        }
+    }
+
+    return sawWrite;
+}
+
+} // namespace Shaderlay
\ No newline at end of file
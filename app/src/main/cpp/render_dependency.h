@@ -0,0 +1,44 @@
+#pragma once
+
+#include "compile_arena.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Shaderlay {
+
+// What a pass's output can change with, ordered from cheapest to redraw
+enum class OutputDependency {
+    Transparent = 0,      // Writes alpha 0 everywhere; drawing can be skipped
+    Constant = 1,         // Same color for every pixel and frame
+    ResolutionOnly = 2,   // Varies across the screen; redraw only on resize
+    TimeDependent = 3     // Reads time, frame count or feedback; redraw every frame
+};
+
+struct PassDependency {
+    OutputDependency dependency = OutputDependency::TimeDependent;
+    bool readsTime = false;
+    bool readsPosition = false;       // Varyings or gl_FragCoord
+    bool samplesTextures = false;
+    bool samplesFeedback = false;     // Previous-frame inputs
+};
+
+// Static analysis of fragment shaders deciding how often their output
+// needs to be redrawn. Uniforms other than time/frame counters are
+// treated as parameters that change only on explicit updates.
+class RenderDependencyAnalyzer {
+public:
+    RenderDependencyAnalyzer();
+    ~RenderDependencyAnalyzer();
+
+    PassDependency analyzePass(const std::string& fragmentSource);
+
+    // Combine per-pass results along a chain; passes that sample their
+    // input inherit the dependency of the pass before them
+    OutputDependency analyzePreset(const std::vector<PassDependency>& passes);
+
+private:
+    bool isOutputTransparent(std::string_view body, const ArenaVector<ArenaString>& outputs);
+};
+
+} // namespace Shaderlay
\ No newline at end of file
@@ -0,0 +1,430 @@
+#include "shader_archive.h"
+#include "native_log.h"
+#include <zlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+#define LOG_TAG "ShaderArchive"
+
+namespace Shaderlay {
+
+namespace {
+
+constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+constexpr uint32_t kEndOfCentralDirSignature = 0x06054b50;
+
+constexpr size_t kLocalHeaderSize = 30;
+constexpr size_t kCentralHeaderSize = 46;
+constexpr size_t kEndOfCentralDirSize = 22;
+constexpr size_t kMaxCommentSize = 0xFFFF;
+
+constexpr uint16_t kMethodStored = 0;
+constexpr uint16_t kMethodDeflate = 8;
+
+constexpr size_t kInflateChunkSize = 64 * 1024;
+
+// Sizes in the central directory are only claims. Deflate cannot expand
+// more than about 1032:1, and nothing in a shader pack comes close to
+// the cap; entries claiming more are refused before anything is reserved.
+constexpr uint64_t kMaxDeflateRatio = 1032;
+constexpr uint64_t kMaxInflatedSize = 64 * 1024 * 1024;
+
+// Zip fields are little-endian and not necessarily aligned
+uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) |
+           (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+} // namespace
+
+ShaderArchive::ShaderArchive() = default;
+
+ShaderArchive::~ShaderArchive() {
+    close();
+}
+
+bool ShaderArchive::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("Failed to open archive: %s", path.c_str());
+        return false;
+    }
+    return openFd(fd);
+}
+
+bool ShaderArchive::openFd(int fd) {
+    close();
+
+    bool mapped = mapFd(fd);
+    ::close(fd);
+    if (!mapped) {
+        return false;
+    }
+
+    if (!indexCentralDirectory()) {
+        close();
+        return false;
+    }
+
+    LOGD("Opened shader archive with %zu entries", entries_.size());
+    return true;
+}
+
+void ShaderArchive::close() {
+    if (base_) {
+        munmap(const_cast<uint8_t*>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+    entries_.clear();
+}
+
+bool ShaderArchive::mapFd(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kEndOfCentralDirSize)) {
+        LOGE("Archive too small or unreadable");
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOGE("Failed to map archive (%zu bytes)", size);
+        return false;
+    }
+
+    // Lookups after indexing jump around the file
+    madvise(mapping, size, MADV_RANDOM);
+
+    base_ = static_cast<const uint8_t*>(mapping);
+    size_ = size;
+    return true;
+}
+
+bool ShaderArchive::indexCentralDirectory() {
+    // The end-of-central-directory record sits before an optional comment
+    size_t searchStart = size_ - kEndOfCentralDirSize;
+    size_t searchEnd = (searchStart > kMaxCommentSize) ? searchStart - kMaxCommentSize : 0;
+    const uint8_t* eocd = nullptr;
+
+    for (size_t pos = searchStart + 1; pos-- > searchEnd;) {
+        if (readU32(base_ + pos) == kEndOfCentralDirSignature) {
+            eocd = base_ + pos;
+            break;
+        }
+    }
+
+    if (!eocd) {
+        LOGE("End of central directory not found");
+        return false;
+    }
+
+    uint16_t entryCount = readU16(eocd + 10);
+    uint32_t directorySize = readU32(eocd + 12);
+    uint32_t directoryOffset = readU32(eocd + 16);
+
+    if (entryCount == 0xFFFF || directoryOffset == 0xFFFFFFFF) {
+        LOGE("Zip64 archives are not supported");
+        return false;
+    }
+    if (static_cast<uint64_t>(directoryOffset) + directorySize > size_) {
+        LOGE("Central directory out of bounds");
+        return false;
+    }
+
+    entries_.reserve(entryCount);
+
+    const uint8_t* cursor = base_ + directoryOffset;
+    const uint8_t* directoryEnd = cursor + directorySize;
+
+    for (uint16_t i = 0; i < entryCount; ++i) {
+        if (cursor + kCentralHeaderSize > directoryEnd ||
+            readU32(cursor) != kCentralHeaderSignature) {
+            LOGE("Corrupt central directory at entry %u", i);
+            return false;
+        }
+
+        uint16_t flags = readU16(cursor + 8);
+        uint16_t nameLength = readU16(cursor + 28);
+        uint16_t extraLength = readU16(cursor + 30);
+        uint16_t commentLength = readU16(cursor + 32);
+
+        const uint8_t* next = cursor + kCentralHeaderSize + nameLength + extraLength + commentLength;
+        if (next > directoryEnd) {
+            LOGE("Central directory entry %u overruns directory", i);
+            return false;
+        }
+
+        std::string name(reinterpret_cast<const char*>(cursor + kCentralHeaderSize), nameLength);
+
+        // Skip directories and encrypted entries
+        if (!name.empty() && name.back() != '/' && (flags & 0x1) == 0) {
+            ArchiveEntry entry;
+            entry.method = readU16(cursor + 10);
+            entry.modified = readU32(cursor + 12);
+            entry.crc32 = readU32(cursor + 16);
+            entry.compressedSize = readU32(cursor + 20);
+            entry.uncompressedSize = readU32(cursor + 24);
+            entry.localHeaderOffset = readU32(cursor + 42);
+            entries_[normalizePath(name)] = entry;
+        }
+
+        cursor = next;
+    }
+
+    return true;
+}
+
+bool ShaderArchive::hasEntry(const std::string& path) const {
+    return findEntry(path) != nullptr;
+}
+
+const ArchiveEntry* ShaderArchive::findEntry(const std::string& path) const {
+    auto it = entries_.find(normalizePath(path));
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+const uint8_t* ShaderArchive::entryData(const ArchiveEntry& entry) const {
+    // Local header name/extra lengths can differ from the central directory copy
+    if (entry.localHeaderOffset + kLocalHeaderSize > size_) {
+        return nullptr;
+    }
+
+    const uint8_t* header = base_ + entry.localHeaderOffset;
+    if (readU32(header) != kLocalHeaderSignature) {
+        return nullptr;
+    }
+
+    uint64_t dataOffset = entry.localHeaderOffset + kLocalHeaderSize +
+                          readU16(header + 26) + readU16(header + 28);
+    if (dataOffset + entry.compressedSize > size_) {
+        return nullptr;
+    }
+
+    return base_ + dataOffset;
+}
+
+bool ShaderArchive::getStoredView(const std::string& path, ArchiveEntryView& view) const {
+    const ArchiveEntry* entry = findEntry(path);
+    if (!entry || entry->method != kMethodStored) {
+        return false;
+    }
+
+    // entryData() bounds-checks compressedSize, so that is the size handed out
+    if (entry->compressedSize != entry->uncompressedSize) {
+        LOGE("Stored entry size mismatch: %s", path.c_str());
+        return false;
+    }
+
+    const uint8_t* data = entryData(*entry);
+    if (!data) {
+        LOGE("Invalid local header for: %s", path.c_str());
+        return false;
+    }
+
+    view.data = data;
+    view.size = static_cast<size_t>(entry->compressedSize);
+    return true;
+}
+
+bool ShaderArchive::checkEntrySize(const ArchiveEntry& entry, const std::string& path) const {
+    bool plausible;
+    if (entry.method == kMethodStored) {
+        plausible = entry.uncompressedSize == entry.compressedSize && entry.compressedSize <= size_;
+    } else {
+        plausible = entry.compressedSize <= size_ && entry.uncompressedSize <= kMaxInflatedSize &&
+                    entry.uncompressedSize <= entry.compressedSize * kMaxDeflateRatio;
+    }
+
+    if (!plausible) {
+        LOGE("Implausible entry size %llu (%llu compressed): %s",
+             static_cast<unsigned long long>(entry.uncompressedSize),
+             static_cast<unsigned long long>(entry.compressedSize), path.c_str());
+    }
+    return plausible;
+}
+
+bool ShaderArchive::streamEntry(const std::string& path, const ChunkSink& sink) const {
+    const ArchiveEntry* entry = findEntry(path);
+    if (!entry) {
+        LOGE("Archive entry not found: %s", path.c_str());
+        return false;
+    }
+    if (!checkEntrySize(*entry, path)) {
+        return false;
+    }
+
+    const uint8_t* data = entryData(*entry);
+    if (!data) {
+        LOGE("Invalid local header for: %s", path.c_str());
+        return false;
+    }
+
+    if (entry->method == kMethodStored) {
+        if (entry->compressedSize != entry->uncompressedSize) {
+            LOGE("Stored entry size mismatch: %s", path.c_str());
+            return false;
+        }
+        return sink(data, static_cast<size_t>(entry->compressedSize));
+    }
+
+    if (entry->method != kMethodDeflate) {
+        LOGE("Unsupported compression method %u: %s", entry->method, path.c_str());
+        return false;
+    }
+
+    z_stream stream{};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        LOGE("inflateInit2 failed");
+        return false;
+    }
+
+    std::vector<uint8_t> chunk(kInflateChunkSize);
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = static_cast<uInt>(entry->compressedSize);
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    uint64_t produced = 0;
+    int status = Z_OK;
+    bool keepGoing = true;
+
+    while (status != Z_STREAM_END && keepGoing) {
+        stream.next_out = chunk.data();
+        stream.avail_out = static_cast<uInt>(chunk.size());
+
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END) {
+            LOGE("Inflate failed (%d): %s", status, path.c_str());
+            inflateEnd(&stream);
+            return false;
+        }
+
+        size_t have = chunk.size() - stream.avail_out;
+        if (produced + have > entry->uncompressedSize) {
+            // Stop before the sink grows past the size that was checked
+            LOGE("Entry inflates past its recorded size: %s", path.c_str());
+            inflateEnd(&stream);
+            return false;
+        }
+        if (have > 0) {
+            crc = crc32(crc, chunk.data(), static_cast<uInt>(have));
+            produced += have;
+            keepGoing = sink(chunk.data(), have);
+        } else if (status != Z_STREAM_END) {
+            LOGE("Truncated deflate stream: %s", path.c_str());
+            inflateEnd(&stream);
+            return false;
+        }
+    }
+
+    inflateEnd(&stream);
+
+    if (!keepGoing) {
+        return true;
+    }
+    if (produced != entry->uncompressedSize || crc != entry->crc32) {
+        LOGE("CRC/size mismatch: %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string ShaderArchive::readText(const std::string& path) const {
+    std::string text;
+    const ArchiveEntry* entry = findEntry(path);
+    if (!entry || !checkEntrySize(*entry, path)) {
+        return text;
+    }
+
+    text.reserve(static_cast<size_t>(entry->uncompressedSize));
+    bool ok = streamEntry(path, [&text](const uint8_t* data, size_t size) {
+        text.append(reinterpret_cast<const char*>(data), size);
+        return true;
+    });
+
+    if (!ok) {
+        text.clear();
+    }
+    return text;
+}
+
+std::vector<uint8_t> ShaderArchive::readBytes(const std::string& path) const {
+    std::vector<uint8_t> bytes;
+    const ArchiveEntry* entry = findEntry(path);
+    if (!entry || !checkEntrySize(*entry, path)) {
+        return bytes;
+    }
+
+    bytes.reserve(static_cast<size_t>(entry->uncompressedSize));
+    bool ok = streamEntry(path, [&bytes](const uint8_t* data, size_t size) {
+        bytes.insert(bytes.end(), data, data + size);
+        return true;
+    });
+
+    if (!ok) {
+        bytes.clear();
+    }
+    return bytes;
+}
+
+std::vector<std::string> ShaderArchive::listEntries(const std::string& suffix) const {
+    std::vector<std::string> names;
+    for (const auto& entry : entries_) {
+        const std::string& name = entry.first;
+        if (name.length() >= suffix.length() &&
+            name.compare(name.length() - suffix.length(), suffix.length(), suffix) == 0) {
+            names.push_back(name);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+std::string ShaderArchive::resolvePath(const std::string& presetPath, const std::string& relativePath) {
+    std::string normalized = normalizePath(presetPath);
+    size_t lastSlash = normalized.find_last_of('/');
+    std::string directory = (lastSlash != std::string::npos) ? normalized.substr(0, lastSlash + 1) : "";
+    return normalizePath(directory + relativePath);
+}
+
+std::string ShaderArchive::normalizePath(const std::string& path) {
+    std::vector<std::string> segments;
+    std::string segment;
+
+    auto flush = [&segments, &segment]() {
+        if (segment == "..") {
+            if (!segments.empty()) segments.pop_back();
+        } else if (!segment.empty() && segment != ".") {
+            segments.push_back(segment);
+        }
+        segment.clear();
+    };
+
+    for (char c : path) {
+        if (c == '/' || c == '\\') {
+            flush();
+        } else {
+            segment += c;
+        }
+    }
+    flush();
+
+    std::string result;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (i > 0) result += '/';
+        result += segments[i];
+    }
+    return result;
+}
+
+} // namespace Shaderlay
\ No newline at end of file
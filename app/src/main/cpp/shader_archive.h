@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace Shaderlay {
+
+struct ArchiveEntry {
+    uint16_t method = 0;              // 0 = stored, 8 = deflate
+    uint32_t crc32 = 0;
+    uint32_t modified = 0;            // DOS time in the low half, date in the high half
+    uint64_t compressedSize = 0;
+    uint64_t uncompressedSize = 0;
+    uint64_t localHeaderOffset = 0;
+};
+
+// Direct view into the mapped archive; only valid while the archive is open
+struct ArchiveEntryView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Read-only shader pack (.zip) served straight from a memory mapping.
+// The central directory is indexed once on open; stored entries are
+// returned without copying and deflated entries are inflated in chunks.
+class ShaderArchive {
+public:
+    // Receives successive chunks of entry data; return false to stop early
+    using ChunkSink = std::function<bool(const uint8_t* data, size_t size)>;
+
+    ShaderArchive();
+    ~ShaderArchive();
+
+    bool open(const std::string& path);
+    // Takes ownership of fd; it is closed once mapped
+    bool openFd(int fd);
+    void close();
+
+    bool isOpen() const { return base_ != nullptr; }
+    size_t getEntryCount() const { return entries_.size(); }
+
+    bool hasEntry(const std::string& path) const;
+    const ArchiveEntry* findEntry(const std::string& path) const;
+
+    // Zero-copy access; fails for compressed entries
+    bool getStoredView(const std::string& path, ArchiveEntryView& view) const;
+
+    // Stream an entry through sink, inflating if needed
+    bool streamEntry(const std::string& path, const ChunkSink& sink) const;
+
+    // Whole-entry reads for .slang/.slangp text and LUT images
+    std::string readText(const std::string& path) const;
+    std::vector<uint8_t> readBytes(const std::string& path) const;
+
+    // Entry names ending in suffix, e.g. ".slangp"
+    std::vector<std::string> listEntries(const std::string& suffix) const;
+
+    // Resolve a path referenced from a preset relative to the preset's directory
+    static std::string resolvePath(const std::string& presetPath, const std::string& relativePath);
+    static std::string normalizePath(const std::string& path);
+
+private:
+    bool mapFd(int fd);
+    bool indexCentralDirectory();
+    const uint8_t* entryData(const ArchiveEntry& entry) const;
+    // Rejects sizes no real entry of this archive can have
+    bool checkEntrySize(const ArchiveEntry& entry, const std::string& path) const;
+
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    std::unordered_map<std::string, ArchiveEntry> entries_;
+};
+
+} // namespace Shaderlay
\ No newline at end of file
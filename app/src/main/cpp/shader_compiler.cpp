@@ -1,18 +1,121 @@
 #include "shader_compiler.h"
-#include <android/log.h>
+#include "glsl_lexer.h"
+#include "native_log.h"
 #include <string>
 #include <vector>
 #include <fstream>
-#include <sstream>
+#include <cctype>
 
 #define LOG_TAG "ShaderCompiler"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 namespace Shaderlay {
 
+namespace {
+
+// Vulkan-side names and what the GLES chain provides instead
+struct SlangRename {
+    const char* from;
+    const char* to;
+};
+
+constexpr SlangRename kSlangRenames[] = {
+    {"vTexCoord", "v_TexCoord"}, {"FragColor", "gl_FragColor"},
+    {"SourceSize", "u_SourceSize"}, {"OutputSize", "u_OutputSize"}, {"FrameCount", "u_FrameCount"},
+};
+
+// Next occurrence of word that is not part of a longer identifier
+size_t findWord(std::string_view text, std::string_view word, size_t from) {
+    size_t pos = from;
+    while ((pos = text.find(word, pos)) != std::string_view::npos) {
+        bool startsWord = pos == 0 || !GlslLexer::isIdentifierChar(text[pos - 1]);
+        size_t end = pos + word.size();
+        bool endsWord = end >= text.size() || !GlslLexer::isIdentifierChar(text[end]);
+        if (startsWord && endsWord) {
+            return pos;
+        }
+        pos = end;
+    }
+    return std::string_view::npos;
+}
+
+size_t skipSpace(std::string_view text, size_t pos) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+        pos++;
+    }
+    return pos;
+}
+
+std::string_view trim(std::string_view text) {
+    size_t start = skipSpace(text, 0);
+    size_t end = text.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        end--;
+    }
+    return text.substr(start, end - start);
+}
+
+// Rewrites push constant and UBO blocks as one uniform per member and
+// returns the instance names (params, global) that prefixed them
+ArenaVector<ArenaString> flattenUniformBlocks(ArenaString& text) {
+    ArenaVector<ArenaString> instances;
+    size_t pos = 0;
+
+    while ((pos = findWord(text, "uniform", pos)) != std::string::npos) {
+        size_t nameStart = skipSpace(text, pos + 7);
+        size_t nameEnd = nameStart;
+        while (nameEnd < text.size() && GlslLexer::isIdentifierChar(text[nameEnd])) {
+            nameEnd++;
+        }
+        size_t brace = skipSpace(text, nameEnd);
+        if (nameEnd == nameStart || brace >= text.size() || text[brace] != '{') {
+            pos = nameEnd;
+            continue;
+        }
+
+        size_t closeBrace = text.find('}', brace);
+        size_t semicolon = closeBrace == std::string::npos ? closeBrace : text.find(';', closeBrace);
+        if (semicolon == std::string::npos) {
+            break;
+        }
+
+        std::string_view instance = trim(std::string_view(text).substr(closeBrace + 1, semicolon - closeBrace - 1));
+        if (!instance.empty()) {
+            instances.emplace_back(instance);
+        }
+
+        ArenaString uniforms;
+        std::string_view body = std::string_view(text).substr(brace + 1, closeBrace - brace - 1);
+        size_t memberStart = 0;
+        while (memberStart < body.size()) {
+            size_t memberEnd = body.find(';', memberStart);
+            if (memberEnd == std::string_view::npos) memberEnd = body.size();
+            std::string_view member = trim(body.substr(memberStart, memberEnd - memberStart));
+            memberStart = memberEnd + 1;
+            if (member.empty()) {
+                continue;
+            }
+
+            // GLES 2 has no unsigned types; counters arrive as floats
+            uniforms += "uniform ";
+            if (member.compare(0, 5, "uint ") == 0) {
+                uniforms += "float";
+                member.remove_prefix(4);
+            }
+            uniforms += member;
+            uniforms += ";\n";
+        }
+
+        text.replace(pos, semicolon + 1 - pos, uniforms);
+        pos += uniforms.size();
+    }
+
+    return instances;
+}
+
+} // namespace
+
 ShaderCompiler::ShaderCompiler() {
-    LOGI("ShaderCompiler initialized");
+    LOGD("ShaderCompiler initialized");
 }
 
 ShaderCompiler::~ShaderCompiler() {
@@ -22,73 +125,199 @@ ShaderCompiler::~ShaderCompiler() {
 bool ShaderCompiler::initialize() {
     // For now, we'll use a simplified approach without glslang
     // In a full implementation, this would initialize glslang
-    LOGI("Shader compiler initialization (simplified)");
+    LOGD("Shader compiler initialization (simplified)");
     return true;
 }
 
 void ShaderCompiler::cleanup() {
     // Cleanup resources
-    LOGI("Shader compiler cleanup");
+    LOGD("Shader compiler cleanup");
 }
 
 std::string ShaderCompiler::compileGLSL(const std::string& source, ShaderType type) {
-    LOGI("Compiling GLSL shader, type: %d", static_cast<int>(type));
+    LOGV("Compiling GLSL shader, type: %d", static_cast<int>(type));
 
     // For now, return the source as-is since we're using GLSL directly
     // In a full implementation, this would compile to SPIR-V and back to GLSL
-    return preprocessGLSL(source, type);
+    std::string processed = preprocessGLSL(source, type);
+
+    // Qualify each variable individually instead of one blanket default
+    if (type == ShaderType::Fragment) {
+        processed = precisionAnalyzer_.qualify(processed);
+        lastPrecisionReport_ = precisionAnalyzer_.getReport();
+        lastOutputDependency_ = dependencyAnalyzer_.analyzePass(processed);
+    }
+
+    return processed;
+}
+
+std::string ShaderCompiler::compileSlangPass(const std::string& source) {
+    ArenaString converted = convertSlangFragment(source);
+    return compileGLSL(std::string(converted.data(), converted.size()), ShaderType::Fragment);
+}
+
+PrecisionReport ShaderCompiler::getLastPrecisionReport() const {
+    return lastPrecisionReport_;
+}
+
+PassDependency ShaderCompiler::getLastOutputDependency() const {
+    return lastOutputDependency_;
 }
 
 std::vector<uint32_t> ShaderCompiler::compileToSPIRV(const std::string& source, ShaderType type) {
-    LOGI("Compiling to SPIR-V, type: %d", static_cast<int>(type));
+    LOGV("Compiling to SPIR-V, type: %d", static_cast<int>(type));
 
     // Placeholder implementation
     // In a real implementation, this would use glslang to compile to SPIR-V
     std::vector<uint32_t> spirv;
 
     // Return empty vector for now
-    LOGI("SPIR-V compilation not yet implemented");
+    LOGW("SPIR-V compilation not yet implemented");
     return spirv;
 }
 
 std::string ShaderCompiler::preprocessGLSL(const std::string& source, ShaderType type) {
-    std::stringstream processed;
-    std::istringstream sourceStream(source);
-    std::string line;
+    // Line splitting and keyword rewriting use the current compile arena;
+    // only the final result is copied out to the heap
+    std::string_view sourceView(source);
+    ArenaVector<std::string_view> lines;
 
     // Add version header if not present
     bool hasVersion = false;
-    std::vector<std::string> lines;
+    size_t lineStart = 0;
+
+    while (lineStart < sourceView.size()) {
+        size_t lineEnd = sourceView.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = sourceView.size();
+        }
 
-    while (std::getline(sourceStream, line)) {
-        if (line.find("#version") != std::string::npos) {
+        std::string_view line = sourceView.substr(lineStart, lineEnd - lineStart);
+        if (line.find("#version") != std::string_view::npos) {
             hasVersion = true;
         }
         lines.push_back(line);
+        lineStart = lineEnd + 1;
     }
 
+    ArenaString processed;
+    processed.reserve(source.size() + 64);
+
     if (!hasVersion) {
-        processed << "#version 100\n";
+        processed += "#version 100\n";
         if (type == ShaderType::Fragment) {
-            processed << "precision mediump float;\n";
+            processed += "precision mediump float;\n";
         }
     }
 
     // Process each line
-    for (const auto& sourceLine : lines) {
-        std::string processedLine = sourceLine;
-
+    for (std::string_view sourceLine : lines) {
         // Handle common slang-to-GLSL conversions
-        processedLine = replaceSlangKeywords(processedLine);
+        processed += replaceSlangKeywords(sourceLine);
+        processed += '\n';
+    }
+
+    return std::string(processed.data(), processed.size());
+}
+
+ArenaString ShaderCompiler::convertSlangFragment(std::string_view source) {
+    // The shared prelude plus the fragment stage; the chain has its own vertex shader
+    ArenaString text = GlslLexer::fragmentStage(source);
+
+    // Bindings, locations and std140 have no GLES 2 equivalent
+    size_t pos = 0;
+    while ((pos = findWord(text, "layout", pos)) != std::string::npos) {
+        size_t open = skipSpace(text, pos + 6);
+        if (open >= text.size() || text[open] != '(') {
+            pos = open;
+            continue;
+        }
+        size_t close = findMatchingParen(text, open + 1);
+        if (close == std::string::npos) {
+            break;
+        }
+        text.erase(pos, skipSpace(text, close + 1) - pos);
+    }
 
-        processed << processedLine << "\n";
+    ArenaVector<ArenaString> instances = flattenUniformBlocks(text);
+    for (const auto& instance : instances) {
+        ArenaString prefix(instance);
+        prefix += '.';
+        pos = 0;
+        while ((pos = text.find(prefix, pos)) != std::string::npos) {
+            if (pos > 0 && GlslLexer::isIdentifierChar(text[pos - 1])) {
+                pos += prefix.size();
+                continue;
+            }
+            text.erase(pos, prefix.size());
+        }
+    }
+
+    ArenaString converted;
+    converted.reserve(text.size() + 64);
+
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = text.size();
+        std::string_view line = std::string_view(text).substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        std::string_view trimmed = trim(line);
+        if (trimmed.compare(0, 8, "#version") == 0 || trimmed.compare(0, 7, "#pragma") == 0 ||
+            trimmed.compare(0, 4, "out ") == 0) {
+            // Stage markers, parameters and the color output; gl_FragColor replaces the latter
+            converted += '\n';
+            continue;
+        }
+        if (trimmed.compare(0, 3, "in ") == 0) {
+            converted += "varying ";
+            line = trimmed.substr(3);
+        }
+
+        // Whole identifiers only, and not after a member access
+        size_t i = 0;
+        while (i < line.size()) {
+            bool startsWord = GlslLexer::isIdentifierChar(line[i]) && !std::isdigit(static_cast<unsigned char>(line[i])) &&
+                              (i == 0 || !GlslLexer::isIdentifierChar(line[i - 1]));
+            if (!startsWord) {
+                converted += line[i++];
+                continue;
+            }
+
+            size_t end = i;
+            while (end < line.size() && GlslLexer::isIdentifierChar(line[end])) {
+                end++;
+            }
+            std::string_view word = line.substr(i, end - i);
+            bool member = i > 0 && line[i - 1] == '.';
+
+            const char* replacement = nullptr;
+            if (!member) {
+                for (const auto& rename : kSlangRenames) {
+                    if (word == rename.from) replacement = rename.to;
+                }
+                size_t next = skipSpace(line, end);
+                if (word == "texture" && next < line.size() && line[next] == '(') {
+                    replacement = "texture2D";
+                }
+            }
+
+            if (replacement) {
+                converted += replacement;
+            } else {
+                converted += word;
+            }
+            i = end;
+        }
+        converted += '\n';
     }
 
-    return processed.str();
+    return converted;
 }
 
-std::string ShaderCompiler::replaceSlangKeywords(const std::string& line) {
-    std::string result = line;
+ArenaString ShaderCompiler::replaceSlangKeywords(std::string_view line) {
+    ArenaString result(line);
 
     // Replace common slang keywords with GLSL equivalents
     // This is a simplified version - a full implementation would be more comprehensive
@@ -124,8 +353,10 @@ std::string ShaderCompiler::replaceSlangKeywords(const std::string& line) {
     while ((pos = result.find("saturate(", pos)) != std::string::npos) {
         size_t endPos = findMatchingParen(result, pos + 9);
         if (endPos != std::string::npos) {
-            std::string expr = result.substr(pos + 9, endPos - pos - 9);
-            result.replace(pos, endPos - pos + 1, "clamp(" + expr + ", 0.0, 1.0)");
+            ArenaString clamped("clamp(");
+            clamped.append(result, pos + 9, endPos - pos - 9);
+            clamped += ", 0.0, 1.0)";
+            result.replace(pos, endPos - pos + 1, clamped);
         }
         pos++;
     }
@@ -133,7 +364,7 @@ std::string ShaderCompiler::replaceSlangKeywords(const std::string& line) {
     return result;
 }
 
-size_t ShaderCompiler::findMatchingParen(const std::string& str, size_t start) {
+size_t ShaderCompiler::findMatchingParen(std::string_view str, size_t start) {
     int count = 1;
     for (size_t i = start; i < str.length(); ++i) {
         if (str[i] == '(') count++;
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "compile_arena.h"
+#include "precision_analyzer.h"
+#include "render_dependency.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
@@ -22,17 +26,34 @@ public:
     // Compile GLSL source to optimized GLSL
     std::string compileGLSL(const std::string& source, ShaderType type);
 
+    // Compile the fragment stage of a .slang pass for the GLES 2 chain:
+    // Vulkan interface blocks become plain uniforms, and the texture
+    // coordinate, output and size uniforms take the names FrameExecutor
+    // feeds (v_TexCoord, gl_FragColor, u_SourceSize, ...)
+    std::string compileSlangPass(const std::string& source);
+
     // Compile to SPIR-V (for future Vulkan support)
     std::vector<uint32_t> compileToSPIRV(const std::string& source, ShaderType type);
 
     // Validate shader source
     bool validateShader(const std::string& source, ShaderType type);
 
+    // Precision qualification results for the most recent fragment compile
+    PrecisionReport getLastPrecisionReport() const;
+
+    // Redraw requirements of the most recent fragment compile
+    PassDependency getLastOutputDependency() const;
+
 private:
     std::string preprocessGLSL(const std::string& source, ShaderType type);
-    std::string replaceSlangKeywords(const std::string& line);
-    size_t findMatchingParen(const std::string& str, size_t start);
-
+    ArenaString convertSlangFragment(std::string_view source);
+    ArenaString replaceSlangKeywords(std::string_view line);
+    size_t findMatchingParen(std::string_view str, size_t start);
+
+    PrecisionAnalyzer precisionAnalyzer_;
+    PrecisionReport lastPrecisionReport_;
+    RenderDependencyAnalyzer dependencyAnalyzer_;
+    PassDependency lastOutputDependency_;
     bool initialized_ = false;
 };
 
@@ -1,39 +1,58 @@
 #include "slang_parser.h"
-#include <android/log.h>
-#include <sstream>
-#include <regex>
+#include "native_log.h"
+#include <cstdlib>
+#include <stdexcept>
 
 #define LOG_TAG "SlangParser"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 namespace Shaderlay {
 
 SlangParser::SlangParser() {
-    LOGI("SlangParser initialized");
+    LOGD("SlangParser initialized");
 }
 
 SlangParser::~SlangParser() = default;
 
 bool SlangParser::parseSlangPreset(const std::string& presetContent) {
-    LOGI("Parsing slang preset");
+    LOGV("Parsing slang preset");
 
     preset_ = SlangPreset{};
-    std::istringstream stream(presetContent);
-    std::string line;
 
-    while (std::getline(stream, line)) {
-        line = trim(line);
+    // Scratch state lives in the current compile arena, if any
+    PresetValues values;
+    std::string_view content(presetContent);
+    size_t lineStart = 0;
+
+    while (lineStart < content.size()) {
+        size_t lineEnd = content.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = content.size();
+        }
+
+        std::string_view line = trim(content.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
 
         // Skip empty lines and comments
         if (line.empty() || line[0] == '#') {
             continue;
         }
 
-        parseLine(line);
+        parseLine(line, values);
+    }
+
+    resolveTextures(values);
+    resolveParameters(values);
+
+    // As in RetroArch, a final pass without a scale type renders at
+    // viewport size rather than at the size of its input
+    if (!preset_.shaders.empty() && !preset_.shaders.back().scaleTypeSet) {
+        SlangShader& last = preset_.shaders.back();
+        last.scaleType = ScaleType::Viewport;
+        last.scaleTypeX = ScaleType::Viewport;
+        last.scaleTypeY = ScaleType::Viewport;
     }
 
-    LOGI("Parsed preset with %zu shaders", preset_.shaders.size());
+    LOGD("Parsed preset with %zu shaders", preset_.shaders.size());
     return !preset_.shaders.empty();
 }
 
@@ -41,104 +60,206 @@ SlangPreset SlangParser::getPreset() const {
     return preset_;
 }
 
-void SlangParser::parseLine(const std::string& line) {
+void SlangParser::parseLine(std::string_view line, PresetValues& values) {
     size_t equalPos = line.find('=');
-    if (equalPos == std::string::npos) {
+    if (equalPos == std::string_view::npos) {
         return;
     }
 
-    std::string key = trim(line.substr(0, equalPos));
-    std::string value = trim(line.substr(equalPos + 1));
+    std::string_view key = trim(line.substr(0, equalPos));
+    std::string_view value = trim(line.substr(equalPos + 1));
 
     // Remove quotes from value
-    if (value.front() == '"' && value.back() == '"') {
+    if (value.length() >= 2 && value.front() == '"' && value.back() == '"') {
         value = value.substr(1, value.length() - 2);
     }
 
+    // Texture and parameter names are only known once their lists are read
+    values[ArenaString(key)] = ArenaString(value);
+
     if (key == "shaders") {
-        preset_.shaderCount = std::stoi(value);
-    } else if (key.find("shader") == 0) {
+        preset_.shaderCount = parseInt(value);
+    } else if (key.compare(0, 6, "shader") == 0) {
         parseShaderLine(key, value);
-    } else if (key.find("filter_linear") == 0) {
+    } else if (key.compare(0, 13, "filter_linear") == 0) {
         parseFilterLine(key, value);
-    } else if (key.find("scale_type") == 0) {
+    } else if (key.compare(0, 10, "scale_type") == 0) {
         parseScaleLine(key, value);
-    } else if (key.find("scale") == 0) {
+    } else if (key.compare(0, 5, "scale") == 0) {
         parseScaleValueLine(key, value);
     }
 }
 
-void SlangParser::parseShaderLine(const std::string& key, const std::string& value) {
+void SlangParser::parseShaderLine(std::string_view key, std::string_view value) {
     // Extract shader index from key like "shader0", "shader1", etc.
-    std::regex indexRegex(R"(shader(\d+))");
-    std::smatch match;
+    int index = passIndex(key, "shader");
+    if (index < 0) {
+        return;
+    }
 
-    if (std::regex_search(key, match, indexRegex)) {
-        int index = std::stoi(match[1]);
+    // Ensure we have enough shader entries
+    while (static_cast<int>(preset_.shaders.size()) <= index) {
+        preset_.shaders.emplace_back();
+    }
 
-        // Ensure we have enough shader entries
-        while (static_cast<int>(preset_.shaders.size()) <= index) {
-            preset_.shaders.emplace_back();
-        }
+    preset_.shaders[index].path = std::string(value);
+    LOGV("Shader %d: %s", index, preset_.shaders[index].path.c_str());
+}
+
+void SlangParser::parseFilterLine(std::string_view key, std::string_view value) {
+    int index = passIndex(key, "filter_linear");
+    if (index < 0) {
+        return;
+    }
 
-        preset_.shaders[index].path = value;
-        LOGI("Shader %d: %s", index, value.c_str());
+    while (static_cast<int>(preset_.shaders.size()) <= index) {
+        preset_.shaders.emplace_back();
     }
+
+    preset_.shaders[index].filterLinear = (value == "true");
 }
 
-void SlangParser::parseFilterLine(const std::string& key, const std::string& value) {
-    std::regex indexRegex(R"(filter_linear(\d+))");
-    std::smatch match;
+void SlangParser::parseScaleLine(std::string_view key, std::string_view value) {
+    bool setX = true;
+    bool setY = true;
+    int index = passIndex(key, "scale_type");
+    if (index < 0) {
+        index = passIndex(key, "scale_type_x");
+        setY = false;
+    }
+    if (index < 0) {
+        index = passIndex(key, "scale_type_y");
+        setX = false;
+        setY = true;
+    }
+    if (index < 0) {
+        return;
+    }
 
-    if (std::regex_search(key, match, indexRegex)) {
-        int index = std::stoi(match[1]);
+    while (static_cast<int>(preset_.shaders.size()) <= index) {
+        preset_.shaders.emplace_back();
+    }
 
-        while (static_cast<int>(preset_.shaders.size()) <= index) {
-            preset_.shaders.emplace_back();
-        }
+    ScaleType type;
+    if (value == "source") {
+        type = ScaleType::Source;
+    } else if (value == "viewport") {
+        type = ScaleType::Viewport;
+    } else if (value == "absolute") {
+        type = ScaleType::Absolute;
+    } else {
+        return;
+    }
 
-        preset_.shaders[index].filterLinear = (value == "true");
+    // scaleType keeps the horizontal type when the axes differ
+    SlangShader& shader = preset_.shaders[index];
+    shader.scaleTypeSet = true;
+    if (setX) {
+        shader.scaleType = type;
+        shader.scaleTypeX = type;
     }
+    if (setY) shader.scaleTypeY = type;
 }
 
-void SlangParser::parseScaleLine(const std::string& key, const std::string& value) {
-    std::regex indexRegex(R"(scale_type(\d+))");
-    std::smatch match;
+void SlangParser::parseScaleValueLine(std::string_view key, std::string_view value) {
+    bool setX = true;
+    bool setY = true;
+    int index = passIndex(key, "scale");
+    if (index < 0) {
+        index = passIndex(key, "scale_x");
+        setY = false;
+    }
+    if (index < 0) {
+        index = passIndex(key, "scale_y");
+        setX = false;
+        setY = true;
+    }
+    if (index < 0) {
+        return;
+    }
 
-    if (std::regex_search(key, match, indexRegex)) {
-        int index = std::stoi(match[1]);
+    while (static_cast<int>(preset_.shaders.size()) <= index) {
+        preset_.shaders.emplace_back();
+    }
 
-        while (static_cast<int>(preset_.shaders.size()) <= index) {
-            preset_.shaders.emplace_back();
+    float scale = parseFloat(value);
+    SlangShader& shader = preset_.shaders[index];
+    if (setX && setY) shader.scale = scale;
+    if (setX) shader.scaleX = scale;
+    if (setY) shader.scaleY = scale;
+}
+
+void SlangParser::resolveTextures(const PresetValues& values) {
+    auto list = values.find(std::string_view("textures"));
+    if (list == values.end()) {
+        return;
+    }
+
+    for (std::string_view name : splitList(list->second)) {
+        auto path = values.find(name);
+        if (path == values.end()) {
+            LOGW("Texture %.*s has no path", static_cast<int>(name.size()), name.data());
+            continue;
         }
 
-        if (value == "source") {
-            preset_.shaders[index].scaleType = ScaleType::Source;
-        } else if (value == "viewport") {
-            preset_.shaders[index].scaleType = ScaleType::Viewport;
-        } else if (value == "absolute") {
-            preset_.shaders[index].scaleType = ScaleType::Absolute;
+        SlangTexture texture;
+        texture.name = std::string(name);
+        texture.path = std::string(path->second.data(), path->second.size());
+
+        ArenaString linearKey(name);
+        linearKey += "_linear";
+        auto linear = values.find(linearKey);
+        if (linear != values.end()) {
+            texture.filterLinear = (linear->second == "true");
         }
+
+        preset_.textures.push_back(std::move(texture));
     }
 }
 
-void SlangParser::parseScaleValueLine(const std::string& key, const std::string& value) {
-    std::regex indexRegex(R"(scale(\d+))");
-    std::smatch match;
+void SlangParser::resolveParameters(const PresetValues& values) {
+    auto list = values.find(std::string_view("parameters"));
+    if (list == values.end()) {
+        return;
+    }
+
+    for (std::string_view name : splitList(list->second)) {
+        if (preset_.parameterCount >= 32) {
+            LOGW("Too many parameters, ignoring %.*s", static_cast<int>(name.size()), name.data());
+            break;
+        }
 
-    if (std::regex_search(key, match, indexRegex)) {
-        int index = std::stoi(match[1]);
+        auto& parameter = preset_.parameters[preset_.parameterCount++];
+        parameter.name = std::string(name);
 
-        while (static_cast<int>(preset_.shaders.size()) <= index) {
-            preset_.shaders.emplace_back();
+        auto value = values.find(name);
+        if (value != values.end()) {
+            parameter.defaultValue = parseFloat(value->second);
         }
+    }
+}
+
+ArenaVector<std::string_view> SlangParser::splitList(std::string_view value) {
+    ArenaVector<std::string_view> items;
+    size_t start = 0;
 
-        preset_.shaders[index].scale = std::stof(value);
+    while (start <= value.size()) {
+        size_t end = value.find(';', start);
+        if (end == std::string_view::npos) {
+            end = value.size();
+        }
+
+        std::string_view item = trim(value.substr(start, end - start));
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+        start = end + 1;
     }
+    return items;
 }
 
 std::string SlangParser::loadShaderSource(const std::string& shaderPath) {
-    LOGI("Loading shader source: %s", shaderPath.c_str());
+    LOGV("Loading shader source: %s", shaderPath.c_str());
 
     // In a real implementation, this would load from assets or filesystem
     // For now, return a simple placeholder
@@ -279,14 +400,47 @@ void main() {
 )";
 }
 
-std::string SlangParser::trim(const std::string& str) {
+std::string_view SlangParser::trim(std::string_view str) {
     size_t start = str.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos) {
-        return "";
+    if (start == std::string_view::npos) {
+        return std::string_view();
     }
 
     size_t end = str.find_last_not_of(" \t\r\n");
     return str.substr(start, end - start + 1);
 }
 
+int SlangParser::passIndex(std::string_view key, std::string_view prefix) {
+    // Replaces the former per-call std::regex, which allocated on every line
+    if (key.size() <= prefix.size() || key.compare(0, prefix.size(), prefix) != 0) {
+        return -1;
+    }
+
+    std::string_view digits = key.substr(prefix.size());
+    if (digits.find_first_not_of("0123456789") != std::string_view::npos) {
+        return -1;
+    }
+    return parseInt(digits);
+}
+
+int SlangParser::parseInt(std::string_view value) {
+    ArenaString text(value);
+    char* end = nullptr;
+    long result = std::strtol(text.c_str(), &end, 10);
+    if (end == text.c_str()) {
+        throw std::invalid_argument("Invalid integer in preset");
+    }
+    return static_cast<int>(result);
+}
+
+float SlangParser::parseFloat(std::string_view value) {
+    ArenaString text(value);
+    char* end = nullptr;
+    float result = std::strtof(text.c_str(), &end);
+    if (end == text.c_str()) {
+        throw std::invalid_argument("Invalid number in preset");
+    }
+    return result;
+}
+
 } // namespace Shaderlay
\ No newline at end of file
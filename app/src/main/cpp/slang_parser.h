@@ -1,6 +1,8 @@
 #pragma once
 
+#include "compile_arena.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Shaderlay {
@@ -15,12 +17,23 @@ struct SlangShader {
     std::string path;
     bool filterLinear = true;
     ScaleType scaleType = ScaleType::Source;
+    ScaleType scaleTypeX = ScaleType::Source;   // Per-axis; scale_typeN sets both
+    ScaleType scaleTypeY = ScaleType::Source;
     float scale = 1.0f;
+    float scaleX = 1.0f;                        // Per-axis; scaleN sets both
+    float scaleY = 1.0f;
+    bool scaleTypeSet = false;                  // Any scale_type key; see parseSlangPreset
     int frameCountMod = 0;
     bool floatFramebuffer = false;
     bool srgbFramebuffer = false;
 };
 
+struct SlangTexture {
+    std::string name;
+    std::string path;
+    bool filterLinear = true;
+};
+
 struct SlangPreset {
     int shaderCount = 0;
     std::vector<SlangShader> shaders;
@@ -35,6 +48,9 @@ struct SlangPreset {
     } parameters[32]; // Max 32 parameters
 
     int parameterCount = 0;
+
+    // Lookup textures declared via textures = "A;B"
+    std::vector<SlangTexture> textures;
 };
 
 class SlangParser {
@@ -49,11 +65,16 @@ public:
     std::string loadShaderSource(const std::string& shaderPath);
 
 private:
-    void parseLine(const std::string& line);
-    void parseShaderLine(const std::string& key, const std::string& value);
-    void parseFilterLine(const std::string& key, const std::string& value);
-    void parseScaleLine(const std::string& key, const std::string& value);
-    void parseScaleValueLine(const std::string& key, const std::string& value);
+    using PresetValues = ArenaMap<ArenaString, ArenaString>;
+
+    void parseLine(std::string_view line, PresetValues& values);
+    void parseShaderLine(std::string_view key, std::string_view value);
+    void parseFilterLine(std::string_view key, std::string_view value);
+    void parseScaleLine(std::string_view key, std::string_view value);
+    void parseScaleValueLine(std::string_view key, std::string_view value);
+    void resolveTextures(const PresetValues& values);
+    void resolveParameters(const PresetValues& values);
+    ArenaVector<std::string_view> splitList(std::string_view value);
 
     std::string generatePlaceholderShader(const std::string& shaderPath);
     std::string generateCRTShader();
@@ -61,7 +82,11 @@ private:
     std::string generateLCDShader();
     std::string generatePassthroughShader();
 
-    std::string trim(const std::string& str);
+    std::string_view trim(std::string_view str);
+    // Index suffix of keys like "shader3"; -1 if key is not prefix + digits
+    int passIndex(std::string_view key, std::string_view prefix);
+    int parseInt(std::string_view value);
+    float parseFloat(std::string_view value);
 
     SlangPreset preset_;
 };
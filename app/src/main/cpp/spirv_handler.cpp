@@ -1,30 +1,28 @@
 #include "spirv_handler.h"
-#include <android/log.h>
+#include "native_log.h"
 
 #define LOG_TAG "SPIRVHandler"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 namespace Shaderlay {
 
 SPIRVHandler::SPIRVHandler() {
-    LOGI("SPIRVHandler initialized");
+    LOGD("SPIRVHandler initialized");
 }
 
 SPIRVHandler::~SPIRVHandler() = default;
 
 bool SPIRVHandler::initialize() {
-    LOGI("SPIRV handler initialization (placeholder)");
+    LOGD("SPIRV handler initialization (placeholder)");
     // In a full implementation, this would initialize SPIRV-Cross
     return true;
 }
 
 void SPIRVHandler::cleanup() {
-    LOGI("SPIRV handler cleanup");
+    LOGD("SPIRV handler cleanup");
 }
 
 std::string SPIRVHandler::convertSPIRVToGLSL(const std::vector<uint32_t>& spirv, ShaderType type) {
-    LOGI("Converting SPIR-V to GLSL, size: %zu words", spirv.size());
+    LOGV("Converting SPIR-V to GLSL, size: %zu words", spirv.size());
 
     // Placeholder implementation
     // In a real implementation, this would use SPIRV-Cross to convert SPIR-V to GLSL
@@ -39,7 +37,7 @@ std::string SPIRVHandler::convertSPIRVToGLSL(const std::vector<uint32_t>& spirv,
 }
 
 std::vector<uint32_t> SPIRVHandler::optimizeSPIRV(const std::vector<uint32_t>& spirv) {
-    LOGI("Optimizing SPIR-V, size: %zu words", spirv.size());
+    LOGV("Optimizing SPIR-V, size: %zu words", spirv.size());
 
     // Placeholder implementation
     // In a real implementation, this would use SPIRV-Tools to optimize
@@ -47,7 +45,7 @@ std::vector<uint32_t> SPIRVHandler::optimizeSPIRV(const std::vector<uint32_t>& s
 }
 
 bool SPIRVHandler::validateSPIRV(const std::vector<uint32_t>& spirv) {
-    LOGI("Validating SPIR-V, size: %zu words", spirv.size());
+    LOGV("Validating SPIR-V, size: %zu words", spirv.size());
 
     if (spirv.empty()) {
         LOGE("Empty SPIR-V");
@@ -60,7 +58,7 @@ bool SPIRVHandler::validateSPIRV(const std::vector<uint32_t>& spirv) {
         return false;
     }
 
-    LOGI("SPIR-V validation passed");
+    LOGV("SPIR-V validation passed");
     return true;
 }
 
@@ -0,0 +1,171 @@
+#include "compile_arena.h"
+#include "gpu_cost_estimator.h"
+#include "precision_analyzer.h"
+#include "render_dependency.h"
+#include "test_support.h"
+#include <cstdlib>
+#include <new>
+
+using namespace Shaderlay;
+
+namespace {
+
+// Heap allocations made through operator new on this thread
+thread_local size_t t_heapAllocations = 0;
+
+const char* const kCrtShader =
+    "precision mediump float;\n"
+    "#define TEX(c) texture2D(Source, c)\n"
+    "uniform sampler2D Source;\n"
+    "uniform vec2 OutputSize;\n"
+    "uniform float FrameCount;\n"
+    "varying vec2 vTexCoord;\n"
+    "float scan(float y, float phase) {\n"
+    "    return 0.5 + 0.5 * sin(y * 3.14159 + phase);\n"
+    "}\n"
+    "void main() {\n"
+    "    vec2 pixel = vTexCoord * OutputSize;\n"
+    "    vec3 color = TEX(vTexCoord).rgb;\n"
+    "    float total = 0.0;\n"
+    "    for (int i = 0; i < 4; i++) {\n"
+    "        total += scan(pixel.y, float(i));\n"
+    "    }\n"
+    "    float flicker = fract(FrameCount * 0.01);\n"
+    "    color *= total * 0.25 * (0.9 + 0.1 * flicker);\n"
+    "    gl_FragColor = vec4(clamp(color, 0.0, 1.0), 1.0);\n"
+    "}\n";
+
+// Heap allocations made by run() inside a scope on arena. The arena is
+// warmed up first, as it is in a running compile service.
+template <typename Fn>
+size_t heapAllocationsInScope(CompileArena& arena, Fn run) {
+    {
+        ArenaScope scope(arena);
+        run();
+    }
+    arena.reset();
+
+    ArenaScope scope(arena);
+    size_t before = t_heapAllocations;
+    run();
+    return t_heapAllocations - before;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    t_heapAllocations++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+TEST(containersUseArenaInsideScope) {
+    CompileArena arena;
+    ArenaScope scope(arena);
+    CHECK(currentArena() == &arena);
+
+    size_t before = t_heapAllocations;
+    ArenaVector<int> values;
+    for (int i = 0; i < 100; ++i) values.push_back(i);
+    ArenaString text(64, 'x');
+    size_t arenaBlocks = t_heapAllocations - before;
+
+    // Only the arena's own block bookkeeping touches the heap
+    CHECK(arenaBlocks <= 1);
+    CHECK(arena.getStats().allocationCount > 0);
+    CHECK(arena.getStats().bytesUsed >= 100 * sizeof(int) + 64);
+    CHECK_EQ(values[99], 99);
+}
+
+TEST(allocatorFallsBackToHeapOutsideScope) {
+    CHECK(currentArena() == nullptr);
+
+    size_t before = t_heapAllocations;
+    ArenaVector<int> values(16, 1);
+    CHECK(values.get_allocator().arena() == nullptr);
+    CHECK_EQ(t_heapAllocations - before, 1);
+}
+
+TEST(nestedScopesRestoreOuterArena) {
+    CompileArena outer;
+    CompileArena inner;
+    {
+        ArenaScope outerScope(outer);
+        {
+            ArenaScope innerScope(inner);
+            CHECK(currentArena() == &inner);
+        }
+        CHECK(currentArena() == &outer);
+    }
+    CHECK(currentArena() == nullptr);
+}
+
+TEST(resetKeepsBlocksForNextJob) {
+    CompileArena arena(4096);
+    {
+        ArenaScope scope(arena);
+        ArenaString text(10000, 'x');
+    }
+    ArenaStats used = arena.getStats();
+    arena.reset();
+    ArenaStats stats = arena.getStats();
+
+    CHECK_EQ(stats.bytesUsed, 0);
+    CHECK_EQ(stats.allocationCount, 0);
+    CHECK_EQ(stats.reservedBytes, used.reservedBytes);
+    CHECK_EQ(stats.peakBytesUsed, used.peakBytesUsed);
+
+    ArenaScope scope(arena);
+    size_t before = t_heapAllocations;
+    ArenaString again(10000, 'y');
+    CHECK_EQ(t_heapAllocations - before, 0);
+}
+
+TEST(precisionAnalysisAllocatesOnlyItsResult) {
+    std::string source = kCrtShader;
+    CompileArena arena;
+    PrecisionAnalyzer analyzer;
+    std::string qualified;
+
+    size_t heap = heapAllocationsInScope(arena, [&] { qualified = analyzer.qualify(source); });
+    CHECK(heap <= 1);
+    CHECK(arena.getStats().allocationCount > 0);
+    CHECK_CONTAINS(qualified, "precision mediump float;");
+}
+
+TEST(dependencyAnalysisStaysInArena) {
+    std::string source = kCrtShader;
+    CompileArena arena;
+    RenderDependencyAnalyzer analyzer;
+    PassDependency result;
+
+    size_t heap = heapAllocationsInScope(arena, [&] { result = analyzer.analyzePass(source); });
+    CHECK_EQ(heap, 0);
+    CHECK(arena.getStats().allocationCount > 0);
+    CHECK(result.readsTime);
+}
+
+TEST(costAnalysisStaysInArena) {
+    std::string source = kCrtShader;
+    CompileArena arena;
+    GpuCostEstimator estimator;
+    PassCost cost;
+
+    size_t heap = heapAllocationsInScope(arena, [&] { cost = estimator.analyzePass(source); });
+    CHECK_EQ(heap, 0);
+    CHECK(arena.getStats().allocationCount > 0);
+    CHECK_EQ(cost.textureFetches, 1);
+}
+
+int main() {
+    return ShaderlayTest::runAll();
+}
\ No newline at end of file
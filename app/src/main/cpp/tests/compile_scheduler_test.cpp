@@ -0,0 +1,212 @@
+#include "compile_scheduler.h"
+#include "test_support.h"
+#include <stdexcept>
+
+using namespace Shaderlay;
+
+namespace {
+
+const char* kPreset =
+    "shaders = 3\n"
+    "shader0 = first.slang\n"
+    "shader1 = second.slang\n"
+    "shader2 = third.slang\n";
+
+std::vector<std::string> passSources() {
+    std::vector<std::string> sources;
+    for (int i = 0; i < 3; ++i) {
+        sources.push_back("uniform float marker" + std::to_string(i) + ";\n"
+                          "void main() { gl_FragColor = vec4(marker" + std::to_string(i) + "); }\n");
+    }
+    return sources;
+}
+
+struct Result {
+    std::vector<int> passes;
+    std::vector<std::string> fragments;
+    bool finished = false;
+    CompileStatus status = CompileStatus::Completed;
+    std::string message;
+};
+
+// Collects callbacks from the worker thread
+class Recorder {
+public:
+    CompileScheduler::PassCallback onPass() {
+        return [this](uint64_t ticket, const CompiledPass& pass) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results_[ticket].passes.push_back(pass.index);
+            results_[ticket].fragments.push_back(pass.fragmentSource);
+        };
+    }
+
+    CompileScheduler::FinishCallback onFinish() {
+        return [this](uint64_t ticket, CompileStatus status, const std::string& message) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Result& result = results_[ticket];
+            result.finished = true;
+            result.status = status;
+            result.message = message;
+            order_.push_back(ticket);
+            done_.notify_all();
+        };
+    }
+
+    Result wait(uint64_t ticket) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait_for(lock, std::chrono::seconds(5), [&] { return results_[ticket].finished; });
+        return results_[ticket];
+    }
+
+    std::vector<uint64_t> order() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return order_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::unordered_map<uint64_t, Result> results_;
+    std::vector<uint64_t> order_;
+};
+
+// Holds the single worker inside a job until released
+class Gate {
+public:
+    void block() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        entered_ = true;
+        changed_.notify_all();
+        changed_.wait(lock, [this] { return open_; });
+    }
+
+    void waitUntilEntered() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return entered_; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        changed_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool entered_ = false;
+    bool open_ = false;
+};
+
+} // namespace
+
+TEST(finalPassIsCompiledFirst) {
+    SlangParser parser;
+    CHECK(parser.parseSlangPreset(kPreset));
+    std::vector<int> order = CompileScheduler::compileOrder(parser.getPreset());
+    CHECK_EQ(order.size(), 3);
+    CHECK_EQ(order[0], 2);
+    CHECK_EQ(order[1], 0);
+    CHECK_EQ(order[2], 1);
+}
+
+TEST(compilesTheSubmittedSources) {
+    CompileScheduler scheduler;
+    Recorder recorder;
+
+    uint64_t ticket = scheduler.submit(kPreset, passSources(), 0, recorder.onPass(), recorder.onFinish());
+    Result result = recorder.wait(ticket);
+
+    CHECK(result.finished);
+    CHECK(result.status == CompileStatus::Completed);
+    CHECK(result.message.empty());
+    CHECK_EQ(result.passes.size(), 3);
+    for (size_t i = 0; i < result.passes.size(); ++i) {
+        CHECK_CONTAINS(result.fragments[i], "marker" + std::to_string(result.passes[i]));
+    }
+}
+
+TEST(missingSourcesFailWithMessage) {
+    CompileScheduler scheduler;
+    Recorder recorder;
+
+    std::vector<std::string> sources = passSources();
+    sources.pop_back();
+    uint64_t ticket = scheduler.submit(kPreset, sources, 0, recorder.onPass(), recorder.onFinish());
+    Result result = recorder.wait(ticket);
+
+    CHECK(result.status == CompileStatus::Failed);
+    CHECK(!result.message.empty());
+    CHECK(result.passes.empty());
+}
+
+TEST(unparsablePresetFails) {
+    CompileScheduler scheduler;
+    Recorder recorder;
+
+    uint64_t ticket = scheduler.submit("not a preset", {}, 0, recorder.onPass(), recorder.onFinish());
+    Result result = recorder.wait(ticket);
+
+    CHECK(result.status == CompileStatus::Failed);
+    CHECK_CONTAINS(result.message, "parsing");
+}
+
+TEST(throwingJobFailsAndWorkerSurvives) {
+    CompileScheduler scheduler;
+    Recorder recorder;
+
+    uint64_t failing = scheduler.submit(
+        kPreset, passSources(), 0,
+        [](uint64_t, const CompiledPass&) { throw std::runtime_error("listener exploded"); },
+        recorder.onFinish());
+    Result failed = recorder.wait(failing);
+    CHECK(failed.finished);
+    CHECK(failed.status == CompileStatus::Failed);
+    CHECK(failed.message == "listener exploded");
+
+    uint64_t next = scheduler.submit(kPreset, passSources(), 0, recorder.onPass(), recorder.onFinish());
+    CHECK(recorder.wait(next).status == CompileStatus::Completed);
+}
+
+TEST(cancelStopsBetweenPasses) {
+    CompileScheduler scheduler;
+    Recorder recorder;
+    Gate gate;
+
+    uint64_t ticket = scheduler.submit(
+        kPreset, passSources(), 0,
+        [&gate](uint64_t, const CompiledPass&) { gate.block(); },
+        recorder.onFinish());
+    gate.waitUntilEntered();
+    CHECK(scheduler.cancel(ticket));
+    gate.open();
+
+    CHECK(recorder.wait(ticket).status == CompileStatus::Cancelled);
+    CHECK(!scheduler.cancel(ticket));
+}
+
+TEST(higherPriorityRunsFirst) {
+    CompileScheduler scheduler;
+    Recorder recorder;
+    Gate gate;
+
+    uint64_t blocker = scheduler.submit(
+        kPreset, passSources(), 0,
+        [&gate](uint64_t, const CompiledPass&) { gate.block(); },
+        recorder.onFinish());
+    gate.waitUntilEntered();
+
+    uint64_t background = scheduler.submit(kPreset, passSources(), 0, recorder.onPass(), recorder.onFinish());
+    uint64_t visible = scheduler.submit(kPreset, passSources(), 10, recorder.onPass(), recorder.onFinish());
+    gate.open();
+
+    recorder.wait(background);
+    recorder.wait(visible);
+    std::vector<uint64_t> order = recorder.order();
+    CHECK_EQ(order.size(), 3);
+    CHECK_EQ(order[0], blocker);
+    CHECK_EQ(order[1], visible);
+    CHECK_EQ(order[2], background);
+}
+
+int main() { return ShaderlayTest::runAll(); }
\ No newline at end of file
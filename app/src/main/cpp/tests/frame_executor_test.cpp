@@ -0,0 +1,428 @@
+#include "frame_executor.h"
+#include "recording_backend.h"
+#include "shader_compiler.h"
+#include "slang_parser.h"
+#include "test_support.h"
+#include <fstream>
+#include <sstream>
+
+using namespace Shaderlay;
+
+namespace {
+
+const char* const kThreePassPreset =
+    "shaders = 3\n"
+    "shader0 = blur.slang\n"
+    "scale_type0 = source\n"
+    "scale0 = 0.5\n"
+    "shader1 = sharpen.slang\n"
+    "filter_linear1 = false\n"
+    "shader2 = crt.slang\n";
+
+std::vector<std::string> passSources(int count) {
+    std::vector<std::string> sources;
+    for (int i = 0; i < count; ++i) {
+        sources.push_back("uniform sampler2D Source;\n"
+                          "varying vec2 v_TexCoord;\n"
+                          "void main() { gl_FragColor = texture2D(Source, v_TexCoord) * " +
+                          std::to_string(i + 1) + ".0; }\n");
+    }
+    return sources;
+}
+
+SlangPreset parsePreset(const char* content) {
+    SlangParser parser;
+    CHECK(parser.parseSlangPreset(content));
+    return parser.getPreset();
+}
+
+// Binds and draws of the last frame, without uniform updates
+std::vector<RecordedCall> pipelineCalls(const RecordingBackend& backend) {
+    std::vector<RecordedCall> calls;
+    for (const auto& call : backend.getCommands()) {
+        if (call.command != RecordedCommand::SetUniform) calls.push_back(call);
+    }
+    return calls;
+}
+
+struct Chain {
+    SlangPreset preset;
+    std::vector<std::string> sources;
+};
+
+// Three passes whose last pass runs the given source
+Chain chainEndingWith(const std::string& finalSource) {
+    Chain chain{parsePreset(kThreePassPreset), passSources(2)};
+    chain.sources.push_back(finalSource);
+    return chain;
+}
+
+const RenderTarget* findTarget(const RecordingBackend& backend, uint32_t framebuffer) {
+    for (const auto& target : backend.getLiveTargets()) {
+        if (target.framebuffer == framebuffer) return &target;
+    }
+    return nullptr;
+}
+
+const char* const kLookupPreset =
+    "shaders = 2\n"
+    "shader0 = mask.slang\n"
+    "shader1 = crt.slang\n"
+    "textures = \"MASK;NOISE\"\n"
+    "MASK = \"mask.png\"\n"
+    "MASK_linear = false\n"
+    "NOISE = \"noise.png\"\n";
+
+LookupImage solidImage(const std::string& name, int width, int height, uint8_t value) {
+    LookupImage image;
+    image.name = name;
+    image.width = width;
+    image.height = height;
+    image.pixels.assign(static_cast<size_t>(width) * height * 4, value);
+    return image;
+}
+
+std::string readTestShader(const std::string& path) {
+    std::ifstream file(std::string(SHADERLAY_TEST_SHADERS) + "/" + path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+} // namespace
+
+TEST(threePassChainBindsEachInputBeforeDrawing) {
+    auto owned = std::make_unique<RecordingBackend>(true);
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    CHECK(executor.build(parsePreset(kThreePassPreset), passSources(3), 400, 300));
+    CHECK_EQ(backend.getLiveTargets().size(), 2u);
+    executor.renderFrame(FrameInputs{1.0f, 0.8f});
+
+    std::vector<RecordedCall> calls = pipelineCalls(backend);
+    CHECK_EQ(calls.size(), 1u + 5u + 5u + 6u);
+    if (calls.size() != 17) return;
+
+    CHECK(calls[0].command == RecordedCommand::BindQuad);
+
+    size_t at = 1;
+    uint32_t previousTexture = 0;
+    uint32_t programs[3] = {};
+    for (int pass = 0; pass < 3; ++pass) {
+        bool last = (pass == 2);
+
+        const RecordedCall& framebuffer = calls[at++];
+        CHECK(framebuffer.command == RecordedCommand::BindFramebuffer);
+        if (last) {
+            CHECK_EQ(framebuffer.handle, 0);
+            CHECK_EQ(framebuffer.width, 400);
+            CHECK_EQ(framebuffer.height, 300);
+        } else {
+            const RenderTarget* target = findTarget(backend, framebuffer.handle);
+            CHECK(target != nullptr);
+            if (target) {
+                CHECK_EQ(framebuffer.width, target->width);
+                CHECK_EQ(framebuffer.height, target->height);
+            }
+        }
+
+        const RecordedCall& blending = calls[at++];
+        CHECK(blending.command == RecordedCommand::SetBlending);
+        CHECK_EQ(blending.handle, last ? 1 : 0);
+
+        if (last) {
+            CHECK(calls[at++].command == RecordedCommand::Clear);
+        }
+
+        const RecordedCall& program = calls[at++];
+        CHECK(program.command == RecordedCommand::UseProgram);
+        CHECK(program.handle != 0);
+        programs[pass] = program.handle;
+
+        // Unit 0 gets the previous pass output, or nothing for the first
+        const RecordedCall& texture = calls[at++];
+        CHECK(texture.command == RecordedCommand::BindTexture);
+        CHECK_EQ(texture.slot, 0);
+        CHECK_EQ(texture.handle, previousTexture);
+
+        CHECK(calls[at++].command == RecordedCommand::Draw);
+
+        const RenderTarget* target = findTarget(backend, framebuffer.handle);
+        previousTexture = target ? target->texture : 0;
+    }
+
+    CHECK(programs[0] != programs[1] && programs[1] != programs[2] && programs[0] != programs[2]);
+    CHECK_EQ(executor.getStats().drawCalls, 3);
+    CHECK_EQ(backend.getLastFrameCounters().drawCalls, 3);
+}
+
+TEST(firstBindOfEveryFrameReachesTheBackend) {
+    auto owned = std::make_unique<RecordingBackend>(true);
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    CHECK(executor.build(parsePreset(kThreePassPreset), passSources(3), 400, 300));
+    executor.renderFrame(FrameInputs{});
+    executor.renderFrame(FrameInputs{});
+
+    // State is unknown at the start of a frame, so texture 0 on unit 0
+    // and blending off are set even though the last frame ended that way
+    std::vector<RecordedCall> calls = pipelineCalls(backend);
+    CHECK_EQ(calls.size(), 17u);
+    if (calls.size() != 17) return;
+
+    CHECK(calls[2].command == RecordedCommand::SetBlending);
+    CHECK(calls[2].changedState);
+    CHECK(calls[4].command == RecordedCommand::BindTexture);
+    CHECK_EQ(calls[4].handle, 0);
+    CHECK(calls[4].changedState);
+
+    // The second intermediate pass keeps blending off
+    CHECK(calls[7].command == RecordedCommand::SetBlending);
+    CHECK(!calls[7].changedState);
+    CHECK_EQ(backend.getLastFrameCounters().redundantCalls, 1);
+}
+
+TEST(recordsUniformArguments) {
+    auto owned = std::make_unique<RecordingBackend>(true);
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    CHECK(executor.build(parsePreset(kThreePassPreset), passSources(3), 400, 300));
+    executor.renderFrame(FrameInputs{2.5f, 0.5f});
+
+    bool sawTime = false;
+    bool sawOpacity = false;
+    for (const auto& call : backend.getCommands()) {
+        if (call.command != RecordedCommand::SetUniform) continue;
+        CHECK_EQ(call.valueCount, 1);
+        CHECK(call.slot > 0);
+        if (call.values[0] == 2.5f) sawTime = true;
+        if (call.values[0] == 0.5f) sawOpacity = true;
+    }
+    CHECK(sawTime);
+    CHECK(sawOpacity);
+}
+
+TEST(switchingPresetsReusesSharedPrefix) {
+    auto owned = std::make_unique<RecordingBackend>();
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    Chain a = chainEndingWith("void main() { gl_FragColor = vec4(1.0); }\n");
+    Chain b = chainEndingWith("void main() { gl_FragColor = vec4(0.5); }\n");
+
+    CHECK(executor.build(a.preset, a.sources, 400, 300));
+    BuildStats first = executor.getLastBuildStats();
+    CHECK_EQ(first.reusedPasses, 0);
+    CHECK_EQ(first.compiledPrograms, 3);
+    CHECK_EQ(first.createdTargets, 2);
+    std::vector<RenderTarget> targets = backend.getLiveTargets();
+
+    // A to B only compiles the final pass and keeps both targets
+    CHECK(executor.build(b.preset, b.sources, 400, 300));
+    BuildStats toB = executor.getLastBuildStats();
+    CHECK_EQ(toB.reusedPasses, 2);
+    CHECK_EQ(toB.reusedPrograms, 2);
+    CHECK_EQ(toB.compiledPrograms, 1);
+    CHECK_EQ(toB.createdTargets, 0);
+    CHECK_EQ(toB.reusedTargets, 2);
+
+    // Back to A takes the final program from the cache
+    CHECK(executor.build(a.preset, a.sources, 400, 300));
+    BuildStats toA = executor.getLastBuildStats();
+    CHECK_EQ(toA.reusedPasses, 2);
+    CHECK_EQ(toA.reusedPrograms, 3);
+    CHECK_EQ(toA.compiledPrograms, 0);
+    CHECK_EQ(toA.createdTargets, 0);
+
+    const std::vector<RenderTarget>& live = backend.getLiveTargets();
+    CHECK_EQ(live.size(), targets.size());
+    for (size_t i = 0; i < live.size() && i < targets.size(); ++i) {
+        CHECK_EQ(live[i].framebuffer, targets[i].framebuffer);
+    }
+}
+
+TEST(changedScaleEndsThePrefixAndRecyclesTargets) {
+    auto owned = std::make_unique<RecordingBackend>();
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    SlangPreset preset = parsePreset(kThreePassPreset);
+    std::vector<std::string> sources = passSources(3);
+    CHECK(executor.build(preset, sources, 400, 300));
+
+    // Pass 1 now renders at half size; pass 0 and its target stay
+    SlangPreset scaled = preset;
+    scaled.shaders[1].scaleX = 0.5f;
+    scaled.shaders[1].scaleY = 0.5f;
+    CHECK(executor.build(scaled, sources, 400, 300));
+
+    BuildStats stats = executor.getLastBuildStats();
+    CHECK_EQ(stats.reusedPasses, 1);
+    CHECK_EQ(stats.compiledPrograms, 0);
+    CHECK_EQ(stats.reusedPrograms, 3);
+    CHECK_EQ(stats.reusedTargets, 1);
+    CHECK_EQ(stats.createdTargets, 1);
+
+    // The replaced target was destroyed, not leaked
+    CHECK_EQ(backend.getLiveTargets().size(), 2u);
+}
+
+TEST(failedBuildReleasesTheWholeChain) {
+    auto owned = std::make_unique<RecordingBackend>();
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    Chain a = chainEndingWith("void main() { gl_FragColor = vec4(1.0); }\n");
+    CHECK(executor.build(a.preset, a.sources, 400, 300));
+    CHECK(backend.getLiveResources() > 0);
+
+    // An empty source fails to compile after the prefix was taken over
+    Chain broken = chainEndingWith("");
+    CHECK(!executor.build(broken.preset, broken.sources, 400, 300));
+    CHECK(!executor.isReady());
+    CHECK_EQ(backend.getLiveResources(), 0);
+    CHECK(backend.getLiveTargets().empty());
+
+    executor.renderFrame(FrameInputs{});
+    CHECK_EQ(backend.getCounters().drawCalls, 0);
+
+    // A fresh build after the failure starts from nothing
+    CHECK(executor.build(a.preset, a.sources, 400, 300));
+    CHECK_EQ(executor.getLastBuildStats().compiledPrograms, 3);
+}
+
+TEST(programCacheStaysBounded) {
+    auto owned = std::make_unique<RecordingBackend>();
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    SlangPreset preset = parsePreset("shaders = 1\nshader0 = a.slang\n");
+    for (int i = 0; i < 20; ++i) {
+        std::vector<std::string> sources = {
+            "void main() { gl_FragColor = vec4(" + std::to_string(i) + ".0); }\n"};
+        CHECK(executor.build(preset, sources, 400, 300));
+    }
+
+    // Quad, the live program and at most eight parked programs
+    CHECK(backend.getLiveResources() <= 10);
+
+    executor.release();
+    CHECK_EQ(backend.getLiveResources(), 0);
+}
+
+TEST(lookupTexturesAreBoundToEveryPassOnTheirOwnUnits) {
+    auto owned = std::make_unique<RecordingBackend>(true);
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    std::vector<LookupImage> images = {solidImage("NOISE", 8, 8, 7), solidImage("MASK", 4, 2, 255)};
+    CHECK(executor.build(parsePreset(kLookupPreset), passSources(2), 400, 300, images));
+    CHECK_EQ(executor.getLastBuildStats().createdTextures, 2);
+
+    // Quad, two programs, one target and both textures
+    CHECK_EQ(backend.getLiveResources(), 6);
+
+    executor.renderFrame(FrameInputs{});
+    uint32_t units[3] = {};
+    int lookupBinds = 0;
+    for (const auto& call : backend.getCommands()) {
+        if (call.command != RecordedCommand::BindTexture || call.slot == 0) continue;
+        CHECK(call.slot == 1 || call.slot == 2);
+        CHECK(call.handle != 0);
+        if (units[call.slot] != 0) {
+            // Same texture again for the second pass, dropped as redundant
+            CHECK_EQ(call.handle, units[call.slot]);
+            CHECK(!call.changedState);
+        }
+        units[call.slot] = call.handle;
+        lookupBinds++;
+    }
+    CHECK_EQ(lookupBinds, 4);
+    CHECK(units[1] != units[2]);
+}
+
+TEST(lookupTexturesAreReusedAcrossRebuilds) {
+    auto owned = std::make_unique<RecordingBackend>();
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    SlangPreset preset = parsePreset(kLookupPreset);
+    std::vector<LookupImage> images = {solidImage("MASK", 4, 2, 255), solidImage("NOISE", 8, 8, 7)};
+    CHECK(executor.build(preset, passSources(2), 400, 300, images));
+    int resources = backend.getLiveResources();
+
+    // Another final pass over the same LUTs uploads nothing
+    std::vector<std::string> sources = passSources(2);
+    sources[1] = "void main() { gl_FragColor = vec4(0.5); }\n";
+    CHECK(executor.build(preset, sources, 400, 300, images));
+    BuildStats stats = executor.getLastBuildStats();
+    CHECK_EQ(stats.reusedTextures, 2);
+    CHECK_EQ(stats.createdTextures, 0);
+
+    // Changed pixels replace only that texture
+    images[1].pixels[0] = 8;
+    CHECK(executor.build(preset, sources, 400, 300, images));
+    stats = executor.getLastBuildStats();
+    CHECK_EQ(stats.reusedTextures, 1);
+    CHECK_EQ(stats.createdTextures, 1);
+
+    // The old program is parked in the cache; the replaced texture is gone
+    CHECK_EQ(backend.getLiveResources(), resources + 1);
+
+    // A preset without textures drops them
+    CHECK(executor.build(parsePreset(kThreePassPreset), passSources(3), 400, 300, images));
+    CHECK_EQ(executor.getLastBuildStats().createdTextures, 0);
+    executor.release();
+    CHECK_EQ(backend.getLiveResources(), 0);
+}
+
+TEST(guestAdvancedNtscBuildsFromSlangSources) {
+    // The same path as a preset picked in the app: raw .slang passes
+    // through the compiler into the chain
+    std::string content = readTestShader("crt-guest-advanced-ntsc.slangp");
+    CHECK(!content.empty());
+    SlangPreset preset = parsePreset(content.c_str());
+    CHECK_EQ(preset.shaders.size(), 18u);
+
+    ShaderCompiler compiler;
+    std::vector<std::string> fragments;
+    for (const auto& shader : preset.shaders) {
+        std::string source = readTestShader(shader.path);
+        CHECK(!source.empty());
+
+        std::string fragment = compiler.compileSlangPass(source);
+        CHECK_CONTAINS(fragment, "#version 100");
+        CHECK_CONTAINS(fragment, "varying");
+        CHECK_CONTAINS(fragment, "v_TexCoord");
+        CHECK_CONTAINS(fragment, "gl_FragColor");
+        CHECK_NOT_CONTAINS(fragment, "#version 450");
+        CHECK_NOT_CONTAINS(fragment, "#pragma stage");
+        CHECK_NOT_CONTAINS(fragment, "layout(");
+        CHECK_NOT_CONTAINS(fragment, "push_constant");
+        CHECK_NOT_CONTAINS(fragment, "params.");
+        CHECK_NOT_CONTAINS(fragment, "gl_Position");
+        fragments.push_back(fragment);
+    }
+    if (fragments.size() != 18) return;
+
+    // Passes sampling the previous pass see it as Source
+    CHECK_CONTAINS(fragments[17], "uniform sampler2D Source;");
+    CHECK_CONTAINS(fragments[17], "vec4 u_SourceSize;");
+
+    auto owned = std::make_unique<RecordingBackend>();
+    RecordingBackend& backend = *owned;
+    FrameExecutor executor(std::move(owned));
+
+    CHECK(executor.build(preset, fragments, 1280, 720));
+    CHECK_EQ(executor.getLastBuildStats().passes, 18);
+    executor.renderFrame(FrameInputs{1.0f, 1.0f});
+    CHECK_EQ(executor.getStats().drawCalls, 18);
+    CHECK_EQ(backend.getLiveTargets().size(), 17u);
+}
+
+int main() {
+    return ShaderlayTest::runAll();
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "glsl_lexer.h"
+#include "test_support.h"
+#include <algorithm>
+
+using namespace Shaderlay;
+
+namespace {
+
+std::string joined(const GlslTokenList& tokens) {
+    std::string result;
+    for (const auto& token : tokens) {
+        if (!result.empty()) result += ' ';
+        result += token.text;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(stripKeepsOffsetsAndCollectsDirectives) {
+    std::string source =
+        "#version 100\n"
+        "// line comment\n"
+        "  #define SCALE(x) \\\n"
+        "      ((x) * 2.0)\n"
+        "float a; /* block\n"
+        "comment */ float b;\n"
+        "#pragma parameter WIDTH \"Width\" 1.0 0.0 4.0 0.1\n";
+
+    GlslDirectiveList directives;
+    ArenaString code = GlslLexer::stripDirectives(source, &directives);
+
+    CHECK_EQ(code.length(), source.length());
+    CHECK_EQ(std::count(code.begin(), code.end(), '\n'), std::count(source.begin(), source.end(), '\n'));
+    CHECK_EQ(code.find("float a;"), source.find("float a;"));
+    CHECK_EQ(code.find("float b;"), source.find("float b;"));
+    CHECK_NOT_CONTAINS(code, "#");
+    CHECK_NOT_CONTAINS(code, "comment");
+    CHECK_NOT_CONTAINS(code, "2.0");
+
+    CHECK_EQ(directives.size(), 3u);
+    if (directives.size() == 3) {
+        CHECK(directives[0] == "version 100");
+        CHECK_CONTAINS(directives[1], "define SCALE(x)");
+        CHECK_CONTAINS(directives[1], "((x) * 2.0)");
+        CHECK(directives[2].compare(0, 16, "pragma parameter") == 0);
+    }
+}
+
+TEST(tokenizeOperatorsAndNumbers) {
+    GlslTokenList tokens = GlslLexer::tokenize("x+=1.0e-5*y; if(a<=b&&c!=0x1F-1) i++;");
+    CHECK(joined(tokens) == "x += 1.0e-5 * y ; if ( a <= b && c != 0x1F - 1 ) i ++ ;");
+
+    CHECK(tokens[0].kind == GlslTokenKind::Identifier);
+    CHECK(tokens[1].kind == GlslTokenKind::Symbol);
+    CHECK(tokens[2].kind == GlslTokenKind::Number);
+    CHECK_EQ(tokens[2].pos, 3u);
+}
+
+TEST(tokenizeRange) {
+    std::string text = "aaa bbb ccc";
+    GlslTokenList tokens = GlslLexer::tokenize(text, 4, 7);
+    CHECK_EQ(tokens.size(), 1u);
+    CHECK(tokens[0].text == "bbb");
+    CHECK_EQ(tokens[0].pos, 4u);
+}
+
+TEST(fragmentStageKeepsPrologue) {
+    std::string source =
+        "#version 450\nlayout(push_constant) uniform Push { float Time; } params;\n"
+        "#pragma stage vertex\nvoid main() { gl_Position = vec4(0.0); }\n"
+        "#pragma stage fragment\nvoid main() { FragColor = vec4(1.0); }\n";
+
+    ArenaString fragment = GlslLexer::fragmentStage(source);
+    CHECK_CONTAINS(fragment, "uniform Push");
+    CHECK_CONTAINS(fragment, "FragColor");
+    CHECK_NOT_CONTAINS(fragment, "gl_Position");
+
+    CHECK(GlslLexer::fragmentStage("void main() {}") == "void main() {}");
+}
+
+TEST(expandObjectAndFunctionMacros) {
+    GlslMacroTable macros = GlslLexer::collectMacros({
+        "define TEX0 vTexCoord",
+        "define COMPAT_TEXTURE(c, d) texture2D(c, d)",
+        "define SAMPLE COMPAT_TEXTURE(Source, TEX0)",
+        "version 100"
+    });
+    CHECK_EQ(macros.size(), 3u);
+    CHECK(macros["COMPAT_TEXTURE"].functionLike);
+    CHECK_EQ(macros["COMPAT_TEXTURE"].params.size(), 2u);
+
+    GlslTokenList tokens = GlslLexer::expandMacros(GlslLexer::tokenize("x = SAMPLE;"), macros);
+    CHECK(joined(tokens) == "x = texture2D ( Source , vTexCoord ) ;");
+    // Expansions report the position of the macro name
+    CHECK_EQ(tokens[2].pos, 4u);
+    CHECK_EQ(tokens.back().pos, 10u);
+
+    // Function-like macro named without arguments is left alone
+    tokens = GlslLexer::expandMacros(GlslLexer::tokenize("COMPAT_TEXTURE;"), macros);
+    CHECK(joined(tokens) == "COMPAT_TEXTURE ;");
+}
+
+TEST(selfReferentialMacrosTerminate) {
+    GlslMacroTable macros = GlslLexer::collectMacros({"define A B + 1", "define B A * 2"});
+    GlslTokenList tokens = GlslLexer::expandMacros(GlslLexer::tokenize("A"), macros);
+    CHECK(joined(tokens) == "A * 2 + 1");
+}
+
+int main() {
+    return ShaderlayTest::runAll();
+}
\ No newline at end of file
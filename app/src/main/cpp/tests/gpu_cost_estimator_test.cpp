@@ -0,0 +1,137 @@
+#include "gpu_cost_estimator.h"
+#include "slang_parser.h"
+#include "test_support.h"
+
+using namespace Shaderlay;
+
+namespace {
+
+PassCost analyze(const std::string& source) {
+    GpuCostEstimator estimator;
+    return estimator.analyzePass(source);
+}
+
+PresetCost estimate(const std::string& presetContent, int passCount) {
+    SlangParser parser;
+    CHECK(parser.parseSlangPreset(presetContent));
+
+    std::vector<std::string> sources(static_cast<size_t>(passCount),
+        "uniform sampler2D Source;\n"
+        "varying vec2 vTexCoord;\n"
+        "void main() { gl_FragColor = texture2D(Source, vTexCoord); }\n");
+    GpuCostEstimator estimator;
+    return estimator.estimatePreset(parser.getPreset(), sources, 100, 100, 400, 300);
+}
+
+} // namespace
+
+TEST(countsFetchesThroughMacrosAndFunctions) {
+    PassCost cost = analyze(
+        "#define TEX(c) texture2D(Source, c)\n"
+        "uniform sampler2D Source;\n"
+        "varying vec2 vTexCoord;\n"
+        "vec4 blur(vec2 c) { return TEX(c) + TEX(c + 0.01); }\n"
+        "void main() {\n"
+        "    gl_FragColor = blur(vTexCoord) * 0.5;\n"
+        "}\n");
+
+    CHECK_EQ(cost.textureFetches, 2);
+    CHECK(cost.aluOps >= 2.0);
+    CHECK(cost.pixelCost > cost.aluOps);
+}
+
+TEST(multipliesLoopBodiesByTripCount) {
+    PassCost cost = analyze(
+        "uniform sampler2D Source;\n"
+        "varying vec2 vTexCoord;\n"
+        "void main() {\n"
+        "    vec4 sum = vec4(0.0);\n"
+        "    for (int i = 0; i < 6; i += 2) {\n"
+        "        sum += texture2D(Source, vTexCoord);\n"
+        "    }\n"
+        "    gl_FragColor = sum;\n"
+        "}\n");
+
+    CHECK_EQ(cost.textureFetches, 3);
+    CHECK_EQ(cost.loopIterations, 3);
+}
+
+TEST(resolvesLoopBoundsFromParameters) {
+    PassCost cost = analyze(
+        "#pragma parameter SIZEV \"Vertical size\" 6.0 1.0 10.0 1.0\n"
+        "uniform sampler2D Source;\n"
+        "varying vec2 vTexCoord;\n"
+        "void main() {\n"
+        "    vec4 sum = vec4(0.0);\n"
+        "    float n = -SIZEV;\n"
+        "    do {\n"
+        "        sum += texture2D(Source, vTexCoord + vec2(0.0, n));\n"
+        "        n = n + 1.0;\n"
+        "    } while (n <= SIZEV);\n"
+        "    gl_FragColor = sum;\n"
+        "}\n");
+
+    CHECK_EQ(cost.textureFetches, 13);
+}
+
+TEST(finalPassDefaultsToViewportScale) {
+    PresetCost cost = estimate(
+        "shaders = 2\n"
+        "shader0 = a.slang\n"
+        "scale_type0 = source\n"
+        "scale0 = 0.5\n"
+        "shader1 = b.slang\n", 2);
+
+    CHECK_EQ(cost.passes.size(), 2u);
+    if (cost.passes.size() == 2) {
+        CHECK_EQ(cost.passes[0].width, 50);
+        CHECK_EQ(cost.passes[0].height, 50);
+        CHECK_EQ(cost.passes[1].width, 400);
+        CHECK_EQ(cost.passes[1].height, 300);
+        CHECK(cost.frameCost == cost.passes[0].frameCost + cost.passes[1].frameCost);
+    }
+}
+
+TEST(explicitFinalScaleIsKept) {
+    PresetCost cost = estimate(
+        "shaders = 2\n"
+        "shader0 = a.slang\n"
+        "shader1 = b.slang\n"
+        "scale_type_x1 = absolute\n"
+        "scale_x1 = 320\n"
+        "scale_type_y1 = source\n"
+        "scale_y1 = 2.0\n", 2);
+
+    CHECK_EQ(cost.passes.size(), 2u);
+    if (cost.passes.size() == 2) {
+        // Intermediate passes without a scale type follow their input
+        CHECK_EQ(cost.passes[0].width, 100);
+        CHECK_EQ(cost.passes[1].width, 320);
+        CHECK_EQ(cost.passes[1].height, 200);
+    }
+}
+
+TEST(selectsHeaviestTierWithinBudget) {
+    const std::string renderer = "Adreno (TM) 740";
+    double unitsPerMs = GpuCostEstimator::deviceThroughput(renderer);
+    CHECK(unitsPerMs > GpuCostEstimator::deviceThroughput("Unknown GPU"));
+
+    // 2 ms, 6 ms and 12 ms against an 8 ms budget
+    std::vector<double> costs = {2.0 * unitsPerMs, 6.0 * unitsPerMs, 12.0 * unitsPerMs};
+    CHECK_EQ(GpuCostEstimator::selectTier(costs, renderer, 8.0), 1);
+    CHECK_EQ(GpuCostEstimator::selectTier(costs, renderer, 16.0), 2);
+    CHECK_EQ(GpuCostEstimator::selectTier(costs, renderer, 2.0), 0);
+}
+
+TEST(selectTierReportsWhenNothingFits) {
+    const std::string renderer = "Mali-T830";
+    double unitsPerMs = GpuCostEstimator::deviceThroughput(renderer);
+
+    std::vector<double> costs = {20.0 * unitsPerMs, 40.0 * unitsPerMs};
+    CHECK_EQ(GpuCostEstimator::selectTier(costs, renderer, 8.0), -1);
+    CHECK_EQ(GpuCostEstimator::selectTier({}, renderer, 8.0), -1);
+}
+
+int main() {
+    return ShaderlayTest::runAll();
+}
\ No newline at end of file
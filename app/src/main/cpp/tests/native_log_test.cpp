@@ -0,0 +1,132 @@
+#include "native_log.h"
+#include "test_support.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define LOG_TAG "NativeLogTest"
+
+using namespace Shaderlay;
+
+namespace {
+
+int sideEffect(int& counter) {
+    return ++counter;
+}
+
+uint32_t currentSecond() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+TEST(levelsBelowMinimumAreNotEvaluated) {
+    int counter = 0;
+    LOGV("verbose %d", sideEffect(counter));
+    LOGD("debug %d", sideEffect(counter));
+    LOGI("info %d", sideEffect(counter));
+    CHECK_EQ(counter, 0);
+
+    LOGW("warn %d", sideEffect(counter));
+    LOGE("error %d", sideEffect(counter));
+    CHECK_EQ(counter, 2);
+}
+
+TEST(admittedLevelsReachTheSink) {
+    NativeLog::flush();
+    NativeLogStats before = NativeLog::getStats();
+
+    LOGW("one warning");
+    LOGE("one error");
+    NativeLog::flush();
+
+    NativeLogStats after = NativeLog::getStats();
+    CHECK_EQ(after.written - before.written, 2u);
+}
+
+TEST(outOfRangeLevelIsIgnored) {
+    NativeLog::flush();
+    NativeLogStats before = NativeLog::getStats();
+
+    LogSite site;
+    NativeLog::write(SHADERLAY_LOG_NONE, LOG_TAG, site, "never written");
+    NativeLog::write(-1, LOG_TAG, site, "never written");
+    NativeLog::flush();
+
+    NativeLogStats after = NativeLog::getStats();
+    CHECK_EQ(after.written, before.written);
+    CHECK_EQ(site.count.load(), 0u);
+}
+
+TEST(callSiteIsRateLimited) {
+    NativeLog::flush();
+    NativeLogStats before = NativeLog::getStats();
+
+    uint32_t startSecond = currentSecond();
+    for (int i = 0; i < 50; ++i) {
+        LOGW("repeated %d", i);
+    }
+    bool sameWindow = currentSecond() == startSecond;
+    NativeLog::flush();
+
+    NativeLogStats after = NativeLog::getStats();
+    uint64_t written = after.written - before.written;
+    uint64_t limited = after.rateLimited - before.rateLimited;
+    CHECK_EQ(written + limited, 50u);
+    if (sameWindow) {
+        // 20 per site per second
+        CHECK_EQ(written, 20u);
+        CHECK_EQ(limited, 30u);
+    } else {
+        CHECK(written >= 20u && written <= 40u);
+    }
+}
+
+TEST(callSitesAreLimitedIndependently) {
+    NativeLog::flush();
+    NativeLogStats before = NativeLog::getStats();
+
+    for (int i = 0; i < 10; ++i) {
+        LOGW("first site %d", i);
+        LOGW("second site %d", i);
+    }
+    NativeLog::flush();
+
+    NativeLogStats after = NativeLog::getStats();
+    CHECK_EQ(after.written - before.written, 20u);
+    CHECK_EQ(after.rateLimited, before.rateLimited);
+}
+
+TEST(concurrentProducersAreAllAccountedFor) {
+    constexpr int kThreads = 8;
+    constexpr int kSitesPerThread = 200;
+
+    NativeLog::flush();
+    NativeLogStats before = NativeLog::getStats();
+
+    // Distinct sites so only the ring bounds what is kept
+    std::vector<LogSite> sites(kThreads * kSitesPerThread);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t, &sites] {
+            for (int i = 0; i < kSitesPerThread; ++i) {
+                NativeLog::write(SHADERLAY_LOG_WARN, LOG_TAG, sites[t * kSitesPerThread + i],
+                                 "thread %d message %d", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    NativeLog::flush();
+
+    NativeLogStats after = NativeLog::getStats();
+    CHECK_EQ((after.written - before.written) + (after.overflowed - before.overflowed),
+             static_cast<uint64_t>(kThreads * kSitesPerThread));
+    CHECK_EQ(after.rateLimited, before.rateLimited);
+}
+
+int main() {
+    return ShaderlayTest::runAll();
+}
\ No newline at end of file
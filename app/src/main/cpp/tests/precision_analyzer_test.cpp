@@ -0,0 +1,238 @@
+#include "precision_analyzer.h"
+#include "compile_arena.h"
+#include "test_support.h"
+
+using namespace Shaderlay;
+
+namespace {
+
+std::string qualify(const std::string& body) {
+    PrecisionAnalyzer analyzer;
+    return analyzer.qualify("precision mediump float;\n" + body);
+}
+
+} // namespace
+
+TEST(repeatedSumIsNotLowp) {
+    std::string result = qualify(
+        "void main() {\n"
+        "    float a = 1.5;\n"
+        "    float s = a + a + a;\n"
+        "    gl_FragColor = vec4(s);\n"
+        "}\n");
+
+    // a + a is computed at the precision of a, so a must hold 3.0 too
+    CHECK_NOT_CONTAINS(result, "lowp float s");
+    CHECK_NOT_CONTAINS(result, "lowp float a");
+}
+
+TEST(constantProductIsNotLowp) {
+    std::string result = qualify(
+        "void main() {\n"
+        "    float g = 1.9 * 1.9;\n"
+        "    gl_FragColor = vec4(g);\n"
+        "}\n");
+
+    CHECK_CONTAINS(result, "float g = 1.9 * 1.9;");
+    CHECK_NOT_CONTAINS(result, "lowp float g");
+}
+
+TEST(constructorArithmeticIsNotLowp) {
+    std::string result = qualify(
+        "void main() {\n"
+        "    vec3 col = vec3(0.9) * 1.5 + vec3(1.0);\n"
+        "    gl_FragColor = vec4(col, 1.0);\n"
+        "}\n");
+
+    CHECK_NOT_CONTAINS(result, "lowp vec3 col");
+}
+
+TEST(smallArithmeticStaysLowp) {
+    PrecisionAnalyzer analyzer;
+    std::string result = analyzer.qualify(
+        "precision mediump float;\n"
+        "void main() {\n"
+        "    float h = 0.5 * 0.5 + 0.25;\n"
+        "    vec3 tint = vec3(0.2) * h - 0.1;\n"
+        "    gl_FragColor = vec4(tint, h);\n"
+        "}\n");
+
+    CHECK_CONTAINS(result, "lowp float h");
+    CHECK_CONTAINS(result, "lowp vec3 tint");
+    CHECK_EQ(analyzer.getReport().lowpCount, 2);
+}
+
+TEST(multiplicativeUpdatesAccumulate) {
+    std::string result = qualify(
+        "void main() {\n"
+        "    float w = 1.0;\n"
+        "    float v = 1.0;\n"
+        "    for (int i = 0; i < 8; i++) {\n"
+        "        w = w * 1.5;\n"
+        "        v *= 1.5;\n"
+        "    }\n"
+        "    gl_FragColor = vec4(w, v, 0.0, 1.0);\n"
+        "}\n");
+
+    CHECK_NOT_CONTAINS(result, "lowp float w");
+    CHECK_NOT_CONTAINS(result, "lowp float v");
+}
+
+TEST(boundedBuiltinsAndClampStayLowp) {
+    std::string result = qualify(
+        "uniform float scale;\n"
+        "void main() {\n"
+        "    float c = clamp(scale * 40.0, 0.0, 1.0);\n"
+        "    float e = exp(c);\n"
+        "    gl_FragColor = vec4(c, e, 0.0, 1.0);\n"
+        "}\n");
+
+    CHECK_CONTAINS(result, "lowp float c");
+    // Unknown range keeps the default
+    CHECK_NOT_CONTAINS(result, "lowp float e");
+}
+
+TEST(localsAreScopedPerFunction) {
+    std::string result = qualify(
+        "float large(float x) {\n"
+        "    float t = x * 1000.0;\n"
+        "    return t;\n"
+        "}\n"
+        "void main() {\n"
+        "    float t = 0.5;\n"
+        "    gl_FragColor = vec4(t * large(0.01));\n"
+        "}\n");
+
+    CHECK_CONTAINS(result, "    float t = x * 1000.0;");
+    CHECK_CONTAINS(result, "    lowp float t = 0.5;");
+}
+
+TEST(parametersAreScopedPerFunction) {
+    std::string result = qualify(
+        "float half(float v) { return v * 0.5; }\n"
+        "float same(float v) { return v; }\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(half(0.5), same(100.0), 0.0, 1.0);\n"
+        "}\n");
+
+    CHECK_CONTAINS(result, "lowp float half(lowp float v)");
+    CHECK_CONTAINS(result, "float same(float v)");
+    CHECK_NOT_CONTAINS(result, "lowp float same");
+}
+
+TEST(positionsStayHighp) {
+    std::string result = qualify(
+        "uniform vec2 u_Resolution;\n"
+        "varying vec2 v_TexCoord;\n"
+        "void main() {\n"
+        "    vec2 pixel = v_TexCoord * u_Resolution;\n"
+        "    float fade = fract(pixel.x);\n"
+        "    gl_FragColor = vec4(fade);\n"
+        "}\n");
+
+    CHECK_CONTAINS(result, "#define SHADERLAY_HIGHP highp");
+    CHECK_CONTAINS(result, "varying SHADERLAY_HIGHP vec2 v_TexCoord");
+    CHECK_CONTAINS(result, "SHADERLAY_HIGHP vec2 pixel");
+    CHECK_NOT_CONTAINS(result, "lowp float fade");
+}
+
+TEST(sampledColorIsMediumpNextToHighpCoordinates) {
+    PrecisionAnalyzer analyzer;
+    std::string result = analyzer.qualify(
+        "precision mediump float;\n"
+        "uniform sampler2D Source;\n"
+        "varying vec2 v_TexCoord;\n"
+        "void main() {\n"
+        "    vec2 uv = v_TexCoord * 0.98 + 0.01;\n"
+        "    vec2 dc = abs(0.5 - uv);\n"
+        "    float vig = 1.0 - dot(dc, dc);\n"
+        "    vec3 col = texture2D(Source, uv).rgb * vig;\n"
+        "    vec4 raw = texture(Source, uv);\n"
+        "    gl_FragColor = vec4(col, raw.a);\n"
+        "}\n");
+
+    // Coordinate math stays highp; the falloff and colors derived from
+    // it do not inherit that
+    CHECK_CONTAINS(result, "SHADERLAY_HIGHP vec2 uv");
+    CHECK_CONTAINS(result, "    float vig = 1.0");
+    CHECK_CONTAINS(result, "    vec3 col = texture2D");
+    CHECK_CONTAINS(result, "    vec4 raw = texture(");
+    CHECK_EQ(analyzer.getReport().mediumpCount, 3);
+}
+
+TEST(structMembersAreLeftAlone) {
+    PrecisionAnalyzer analyzer;
+    std::string result = analyzer.qualify(
+        "precision mediump float;\n"
+        "struct Params { float a; vec2 b; };\n"
+        "uniform Params params;\n"
+        "void main() {\n"
+        "    float t = 0.5;\n"
+        "    gl_FragColor = vec4(params.a * t, params.b, 1.0);\n"
+        "}\n");
+
+    CHECK_CONTAINS(result, "struct Params { float a; vec2 b; };");
+    CHECK_CONTAINS(result, "lowp float t");
+    CHECK_EQ(analyzer.getReport().variableCount, 1);
+    CHECK_EQ(analyzer.getReport().downgradedCount, 1);
+}
+
+TEST(uniformBlockMembersAreNotNarrowed) {
+    PrecisionAnalyzer analyzer;
+    std::string result = analyzer.qualify(
+        "#version 450\n"
+        "layout(push_constant) uniform Push\n"
+        "{\n"
+        "    vec4 SourceSize;\n"
+        "    vec4 OutputSize;\n"
+        "    uint FrameCount;\n"
+        "} params;\n"
+        "layout(std140, set = 0, binding = 0) uniform UBO\n"
+        "{\n"
+        "    mat4 MVP;\n"
+        "    float Gain, Bias;\n"
+        "};\n"
+        "void main()\n"
+        "{\n"
+        "    float level = Gain * 0.5;\n"
+        "    FragColor = vec4(level);\n"
+        "}\n");
+
+    CHECK_CONTAINS(result, "    vec4 SourceSize;\n    vec4 OutputSize;\n");
+    CHECK_CONTAINS(result, "    mat4 MVP;\n    float Gain, Bias;\n");
+    CHECK_NOT_CONTAINS(result, "lowp vec4");
+    CHECK_NOT_CONTAINS(result, "lowp mat4");
+    CHECK_NOT_CONTAINS(result, "SHADERLAY_HIGHP");
+
+    // Gain is an unbounded uniform, so what it feeds is not lowp either
+    CHECK_NOT_CONTAINS(result, "lowp float level");
+    CHECK_EQ(analyzer.getReport().variableCount, 1);
+    CHECK_EQ(analyzer.getReport().downgradedCount, 0);
+}
+
+TEST(longChainsDoNotAllocatePerIteration) {
+    // Declared in reverse, so the fixed point needs one iteration per link.
+    // Copying each expression's source list made this quadratic; ranges
+    // now share one list, leaving a few allocations per variable.
+    const int links = 100;
+    std::string body = "uniform float seed;\nvoid main() {\n";
+    for (int i = links; i >= 1; --i) {
+        body += "    float v" + std::to_string(i) + ";\n";
+    }
+    for (int i = links; i >= 1; --i) {
+        std::string input = i == 1 ? "seed" : "v" + std::to_string(i - 1);
+        body += "    v" + std::to_string(i) + " = " + input + " * 0.5 + sin(seed);\n";
+    }
+    body += "    gl_FragColor = vec4(v" + std::to_string(links) + ");\n}\n";
+
+    CompileArena arena;
+    {
+        ArenaScope scope(arena);
+        qualify(body);
+    }
+    CHECK(arena.getStats().allocationCount < 10u * links);
+}
+
+int main() {
+    return ShaderlayTest::runAll();
+}
\ No newline at end of file
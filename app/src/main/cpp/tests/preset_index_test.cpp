@@ -0,0 +1,143 @@
+#include "preset_index.h"
+#include "test_support.h"
+#include <cstdlib>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Shaderlay;
+
+namespace {
+
+std::string makeTempDir() {
+    char path[] = "/tmp/shaderlay_index_XXXXXX";
+    return mkdtemp(path) ? path : "";
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+void removeTree(const std::string& path) {
+    std::string command = "rm -rf '" + path + "'";
+    if (std::system(command.c_str()) != 0) {
+        std::printf("failed to remove %s\n", path.c_str());
+    }
+}
+
+// root/crt/crt.slangp -> crt.slang, root/stock.slangp -> crt/crt.slang
+std::string makeLibrary() {
+    std::string root = makeTempDir();
+    mkdir((root + "/crt").c_str(), 0755);
+    writeFile(root + "/crt/crt.slang", "#version 450\nvoid main() {}\n");
+    writeFile(root + "/crt/crt.slangp", "shaders = 1\nshader0 = crt.slang\n");
+    writeFile(root + "/stock.slangp", "shaders = 1\nshader0 = crt/crt.slang\n");
+    return root;
+}
+
+} // namespace
+
+TEST(unchangedLibraryIsNotDirty) {
+    std::string root = makeLibrary();
+    PresetIndex index;
+
+    IndexStats first = index.update(root);
+    CHECK_EQ(first.scanned, 2);
+    CHECK_EQ(first.reparsed, 2);
+    CHECK(first.dirty);
+
+    IndexStats second = index.update(root);
+    CHECK_EQ(second.reparsed, 0);
+    CHECK_EQ(second.reused, 2);
+    CHECK(!second.dirty);
+
+    removeTree(root);
+}
+
+TEST(editedDependencyReparsesPreset) {
+    std::string root = makeLibrary();
+    std::string indexPath = root + "/index.bin";
+
+    PresetIndex index;
+    index.update(root);
+    CHECK(index.save(indexPath));
+
+    // The shader changes but no preset does; both presets use it
+    std::string edited = "#version 450\n#pragma parameter GLOW \"Glow\" 0.5 0.0 1.0 0.1\nvoid main() {}\n";
+    writeFile(root + "/crt/crt.slang", edited);
+    IndexStats stats = index.update(root);
+    CHECK_EQ(stats.reparsed, 2);
+    CHECK(stats.dirty);
+    CHECK(index.save(indexPath));
+
+    // A fresh process loads the new metadata and has nothing to save
+    PresetIndex reloaded;
+    CHECK(reloaded.load(indexPath));
+    const IndexedPreset* preset = reloaded.findPreset("stock.slangp");
+    CHECK(preset != nullptr);
+    if (preset) {
+        CHECK_EQ(preset->dependencies.size(), 1u);
+        CHECK_EQ(preset->dependencies[0].size, edited.size());
+        CHECK_EQ(preset->parameters.size(), 1u);
+        CHECK(!preset->parameters.empty() && preset->parameters[0] == "GLOW");
+    }
+    IndexStats afterReload = reloaded.update(root);
+    CHECK_EQ(afterReload.reparsed, 0);
+    CHECK(!afterReload.dirty);
+
+    removeTree(root);
+}
+
+TEST(touchedDependencyOnlyRefreshesStamp) {
+    std::string root = makeLibrary();
+    PresetIndex index;
+    index.update(root);
+
+    // Same contents, new mtime: nothing to re-parse, but the new stamp is saved
+    struct timespec times[2] = {{0, UTIME_OMIT}, {1000000000, 0}};
+    CHECK_EQ(utimensat(AT_FDCWD, (root + "/crt/crt.slang").c_str(), times, 0), 0);
+    IndexStats stats = index.update(root);
+    CHECK_EQ(stats.reparsed, 0);
+    CHECK(stats.dirty);
+
+    const IndexedPreset* preset = index.findPreset("crt/crt.slangp");
+    CHECK(preset != nullptr);
+    if (preset) {
+        CHECK_EQ(preset->dependencies[0].mtime, 1000000000LL * 1000000000LL);
+    }
+
+    removeTree(root);
+}
+
+TEST(removedPresetMarksDirty) {
+    std::string root = makeLibrary();
+    PresetIndex index;
+    index.update(root);
+
+    unlink((root + "/stock.slangp").c_str());
+    IndexStats stats = index.update(root);
+    CHECK_EQ(stats.removed, 1);
+    CHECK(stats.dirty);
+    CHECK(index.findPreset("stock.slangp") == nullptr);
+
+    removeTree(root);
+}
+
+TEST(symlinkCyclesAreWalkedOnce) {
+    std::string root = makeLibrary();
+    CHECK_EQ(symlink("..", (root + "/crt/parent").c_str()), 0);
+    CHECK_EQ(symlink(".", (root + "/crt/self").c_str()), 0);
+
+    PresetIndex index;
+    IndexStats stats = index.update(root);
+    CHECK_EQ(stats.scanned, 2);
+    CHECK(index.findPreset("crt/crt.slangp") != nullptr);
+
+    removeTree(root);
+}
+
+int main() {
+    return ShaderlayTest::runAll();
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "render_dependency.h"
+#include "test_support.h"
+
+using namespace Shaderlay;
+
+namespace {
+
+PassDependency analyze(const std::string& source) {
+    RenderDependencyAnalyzer analyzer;
+    return analyzer.analyzePass(source);
+}
+
+PassDependency pass(OutputDependency dependency, bool samplesTextures) {
+    PassDependency result;
+    result.dependency = dependency;
+    result.samplesTextures = samplesTextures;
+    return result;
+}
+
+} // namespace
+
+TEST(timeUniformMakesPassTimeDependent) {
+    PassDependency result = analyze(
+        "uniform float u_time;\n"
+        "varying vec2 v_texCoord;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(v_texCoord, sin(u_time), 1.0);\n"
+        "}\n");
+
+    CHECK(result.readsTime);
+    CHECK(result.readsPosition);
+    CHECK_EQ(static_cast<int>(result.dependency), static_cast<int>(OutputDependency::TimeDependent));
+}
+
+TEST(positionOnlyPassRedrawsOnResize) {
+    PassDependency result = analyze(
+        "varying vec2 v_texCoord;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(v_texCoord, 0.0, 1.0);\n"
+        "}\n");
+
+    CHECK(!result.readsTime);
+    CHECK(result.readsPosition);
+    CHECK_EQ(static_cast<int>(result.dependency), static_cast<int>(OutputDependency::ResolutionOnly));
+}
+
+TEST(constantColorIsConstant) {
+    PassDependency result = analyze(
+        "uniform vec4 u_color;\n"
+        "void main() {\n"
+        "    gl_FragColor = u_color;\n"
+        "}\n");
+
+    CHECK_EQ(static_cast<int>(result.dependency), static_cast<int>(OutputDependency::Constant));
+}
+
+TEST(zeroAlphaOutputIsTransparent) {
+    PassDependency result = analyze(
+        "void main() {\n"
+        "    gl_FragColor = vec4(1.0, 0.0, 0.0, 0.0);\n"
+        "}\n");
+
+    CHECK_EQ(static_cast<int>(result.dependency), static_cast<int>(OutputDependency::Transparent));
+}
+
+TEST(partialOutputWriteIsNotTransparent) {
+    PassDependency result = analyze(
+        "void main() {\n"
+        "    gl_FragColor = vec4(0.0);\n"
+        "    gl_FragColor.a = 1.0;\n"
+        "}\n");
+
+    CHECK(result.dependency != OutputDependency::Transparent);
+}
+
+TEST(commentsAndParametersAreNotReads) {
+    PassDependency result = analyze(
+        "#pragma parameter TIME_SCALE \"Time scale\" 1.0 0.0 2.0 0.1\n"
+        "void main() {\n"
+        "    // FrameCount would animate this\n"
+        "    gl_FragColor = vec4(0.5, 0.5, 0.5, 1.0); /* u_time */\n"
+        "}\n");
+
+    CHECK(!result.readsTime);
+    CHECK_EQ(static_cast<int>(result.dependency), static_cast<int>(OutputDependency::Constant));
+}
+
+TEST(readsHiddenBehindMacrosCount) {
+    PassDependency result = analyze(
+        "#define TEX0 texture2D(Source, vTexCoord)\n"
+        "#define ANIMATE(x) ((x) * FrameCount)\n"
+        "uniform sampler2D Source;\n"
+        "varying vec2 vTexCoord;\n"
+        "void main() {\n"
+        "    gl_FragColor = TEX0 * ANIMATE(0.01);\n"
+        "}\n");
+
+    CHECK(result.samplesTextures);
+    CHECK(result.readsTime);
+    CHECK_EQ(static_cast<int>(result.dependency), static_cast<int>(OutputDependency::TimeDependent));
+}
+
+TEST(feedbackInputIsTimeDependent) {
+    PassDependency result = analyze(
+        "uniform sampler2D PassFeedback;\n"
+        "varying vec2 vTexCoord;\n"
+        "void main() {\n"
+        "    gl_FragColor = texture2D(PassFeedback, vTexCoord);\n"
+        "}\n");
+
+    CHECK(result.samplesFeedback);
+    CHECK_EQ(static_cast<int>(result.dependency), static_cast<int>(OutputDependency::TimeDependent));
+}
+
+TEST(slangVertexStageIsIgnored) {
+    PassDependency result = analyze(
+        "#version 450\n"
+        "layout(push_constant) uniform Push { uint FrameCount; } params;\n"
+        "#pragma stage vertex\n"
+        "layout(location = 0) out vec2 vTexCoord;\n"
+        "void main() {\n"
+        "    vTexCoord = vec2(float(params.FrameCount));\n"
+        "}\n"
+        "#pragma stage fragment\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "    FragColor = vec4(0.2, 0.4, 0.6, 1.0);\n"
+        "}\n");
+
+    CHECK(!result.readsTime);
+    CHECK_EQ(static_cast<int>(result.dependency), static_cast<int>(OutputDependency::Constant));
+}
+
+TEST(presetInheritsUpstreamThroughSampling) {
+    RenderDependencyAnalyzer analyzer;
+
+    // An animated first pass sampled by a static one animates the chain
+    CHECK_EQ(static_cast<int>(analyzer.analyzePreset({
+                 pass(OutputDependency::TimeDependent, false),
+                 pass(OutputDependency::ResolutionOnly, true)})),
+             static_cast<int>(OutputDependency::TimeDependent));
+
+    // A final pass that ignores its input hides the animation
+    CHECK_EQ(static_cast<int>(analyzer.analyzePreset({
+                 pass(OutputDependency::TimeDependent, false),
+                 pass(OutputDependency::ResolutionOnly, false)})),
+             static_cast<int>(OutputDependency::ResolutionOnly));
+
+    // A transparent final pass draws nothing regardless of upstream
+    CHECK_EQ(static_cast<int>(analyzer.analyzePreset({
+                 pass(OutputDependency::TimeDependent, false),
+                 pass(OutputDependency::Transparent, true)})),
+             static_cast<int>(OutputDependency::Transparent));
+
+    CHECK_EQ(static_cast<int>(analyzer.analyzePreset({})),
+             static_cast<int>(OutputDependency::Transparent));
+}
+
+int main() { return ShaderlayTest::runAll(); }
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "shader_archive.h"
+#include "test_support.h"
+#include <zlib.h>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
+
+using namespace Shaderlay;
+
+namespace {
+
+struct ZipEntry {
+    std::string name;
+    std::string data;
+    bool deflate = false;
+    int64_t uncompressedSize = -1;    // Overrides the recorded size when set
+};
+
+void putU16(std::string& out, uint32_t value) {
+    out += static_cast<char>(value & 0xFF);
+    out += static_cast<char>((value >> 8) & 0xFF);
+}
+
+void putU32(std::string& out, uint32_t value) {
+    putU16(out, value & 0xFFFF);
+    putU16(out, value >> 16);
+}
+
+std::string deflateRaw(const std::string& data) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+// Minimal zip writer: local headers, central directory, end record
+std::string buildZip(const std::vector<ZipEntry>& entries) {
+    std::string archive;
+    std::string directory;
+
+    for (const auto& entry : entries) {
+        std::string payload = entry.deflate ? deflateRaw(entry.data) : entry.data;
+        uint32_t crc = static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(entry.data.data()),
+                                                   static_cast<uInt>(entry.data.size())));
+        uint32_t uncompressed = entry.uncompressedSize >= 0 ? static_cast<uint32_t>(entry.uncompressedSize)
+                                                            : static_cast<uint32_t>(entry.data.size());
+        uint32_t offset = static_cast<uint32_t>(archive.size());
+        uint16_t method = entry.deflate ? 8 : 0;
+
+        putU32(archive, 0x04034b50);
+        putU16(archive, 20);
+        putU16(archive, 0);
+        putU16(archive, method);
+        putU32(archive, 0);
+        putU32(archive, crc);
+        putU32(archive, static_cast<uint32_t>(payload.size()));
+        putU32(archive, uncompressed);
+        putU16(archive, static_cast<uint32_t>(entry.name.size()));
+        putU16(archive, 0);
+        archive += entry.name;
+        archive += payload;
+
+        putU32(directory, 0x02014b50);
+        putU16(directory, 20);
+        putU16(directory, 20);
+        putU16(directory, 0);
+        putU16(directory, method);
+        putU32(directory, 0);
+        putU32(directory, crc);
+        putU32(directory, static_cast<uint32_t>(payload.size()));
+        putU32(directory, uncompressed);
+        putU16(directory, static_cast<uint32_t>(entry.name.size()));
+        putU16(directory, 0);
+        putU16(directory, 0);
+        putU16(directory, 0);
+        putU16(directory, 0);
+        putU32(directory, 0);
+        putU32(directory, offset);
+        directory += entry.name;
+    }
+
+    uint32_t directoryOffset = static_cast<uint32_t>(archive.size());
+    archive += directory;
+
+    putU32(archive, 0x06054b50);
+    putU16(archive, 0);
+    putU16(archive, 0);
+    putU16(archive, static_cast<uint32_t>(entries.size()));
+    putU16(archive, static_cast<uint32_t>(entries.size()));
+    putU32(archive, static_cast<uint32_t>(directory.size()));
+    putU32(archive, directoryOffset);
+    putU16(archive, 0);
+    return archive;
+}
+
+// Writes the archive to a temporary file and opens it
+class TempArchive {
+public:
+    explicit TempArchive(const std::vector<ZipEntry>& entries) {
+        char path[] = "/tmp/shaderlay_archive_XXXXXX";
+        int fd = mkstemp(path);
+        path_ = path;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+        file << buildZip(entries);
+        file.close();
+        opened_ = archive_.open(path_);
+    }
+
+    ~TempArchive() {
+        archive_.close();
+        unlink(path_.c_str());
+    }
+
+    bool opened() const { return opened_; }
+    ShaderArchive& archive() { return archive_; }
+
+private:
+    std::string path_;
+    ShaderArchive archive_;
+    bool opened_ = false;
+};
+
+const char* kShader = "#version 450\nvoid main() { FragColor = vec4(1.0); }\n";
+
+} // namespace
+
+TEST(storedEntryIsViewedInPlace) {
+    std::vector<ZipEntry> entries = {{"pack/crt.slang", kShader}};
+    TempArchive temp(entries);
+    CHECK(temp.opened());
+
+    ArchiveEntryView view;
+    CHECK(temp.archive().getStoredView("pack/crt.slang", view));
+    CHECK_EQ(view.size, std::string(kShader).size());
+    CHECK(std::string(reinterpret_cast<const char*>(view.data), view.size) == kShader);
+    CHECK(temp.archive().readText("pack/crt.slang") == kShader);
+}
+
+TEST(deflatedEntryIsInflated) {
+    std::string large;
+    for (int i = 0; i < 4000; ++i) {
+        large += "float value" + std::to_string(i) + " = 1.0;\n";
+    }
+    std::vector<ZipEntry> entries = {{"pack/big.slang", large, true}};
+    TempArchive temp(entries);
+    CHECK(temp.opened());
+
+    ArchiveEntryView view;
+    CHECK(!temp.archive().getStoredView("pack/big.slang", view));
+    CHECK(temp.archive().readText("pack/big.slang") == large);
+    CHECK_EQ(temp.archive().readBytes("pack/big.slang").size(), large.size());
+}
+
+TEST(storedEntryWithMismatchedSizeIsRejected) {
+    // Claims more bytes than are stored; handing out that size would read
+    // past the entry, and at the end of the mapping past the file
+    ZipEntry forged{"pack/forged.slang", kShader};
+    forged.uncompressedSize = 1 << 20;
+    TempArchive temp(std::vector<ZipEntry>{forged});
+    CHECK(temp.opened());
+
+    ArchiveEntryView view;
+    CHECK(!temp.archive().getStoredView("pack/forged.slang", view));
+    CHECK(temp.archive().readText("pack/forged.slang").empty());
+}
+
+TEST(corruptDeflatedEntryFailsChecks) {
+    ZipEntry entry{"pack/short.slang", kShader, true};
+    entry.uncompressedSize = 3;
+    TempArchive temp(std::vector<ZipEntry>{entry});
+    CHECK(temp.opened());
+    CHECK(temp.archive().readText("pack/short.slang").empty());
+}
+
+TEST(implausibleDeflatedSizeIsRefusedBeforeReading) {
+    // A few bytes of deflate cannot produce 2 GiB; refusing it up front
+    // keeps readBytes from reserving whatever the directory claims
+    ZipEntry forged{"pack/lut.png", kShader, true};
+    forged.uncompressedSize = 0x80000000LL;
+    TempArchive temp(std::vector<ZipEntry>{forged});
+    CHECK(temp.opened());
+    CHECK(temp.archive().readBytes("pack/lut.png").empty());
+    CHECK(!temp.archive().streamEntry("pack/lut.png", [](const uint8_t*, size_t) { return true; }));
+}
+
+TEST(listsAndResolvesPresetPaths) {
+    TempArchive temp({
+        {"pack/crt/crt.slangp", "shaders = 1\nshader0 = ../shaders/crt.slang\n"},
+        {"pack/shaders/crt.slang", kShader},
+        {"pack/lcd.slangp", "shaders = 0\n"},
+    });
+    CHECK(temp.opened());
+    CHECK_EQ(temp.archive().getEntryCount(), 3);
+
+    std::vector<std::string> presets = temp.archive().listEntries(".slangp");
+    CHECK_EQ(presets.size(), 2);
+    CHECK(presets[0] == "pack/crt/crt.slangp");
+    CHECK(presets[1] == "pack/lcd.slangp");
+
+    std::string resolved = ShaderArchive::resolvePath("pack/crt/crt.slangp", "../shaders/crt.slang");
+    CHECK(resolved == "pack/shaders/crt.slang");
+    CHECK(temp.archive().hasEntry(resolved));
+    CHECK(temp.archive().hasEntry("./pack\\shaders/crt.slang"));
+    CHECK(!temp.archive().hasEntry("pack/missing.slang"));
+}
+
+TEST(nonArchiveFailsToOpen) {
+    char path[] = "/tmp/shaderlay_archive_XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    std::string junk(64, 'x');
+    CHECK_EQ(write(fd, junk.data(), junk.size()), static_cast<long long>(junk.size()));
+    ::close(fd);
+
+    ShaderArchive archive;
+    CHECK(!archive.open(path));
+    CHECK(!archive.isOpen());
+    unlink(path);
+}
+
+int main() { return ShaderlayTest::runAll(); }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Minimal test harness for the host build. Each test binary defines its
+// cases with TEST(name) and returns ShaderlayTest::runAll() from main.
+namespace ShaderlayTest {
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TestCase>& registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& failureCount() {
+    static int count = 0;
+    return count;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) {
+        registry().push_back({name, run});
+    }
+};
+
+inline int runAll() {
+    int failedCases = 0;
+    for (const auto& test : registry()) {
+        int before = failureCount();
+        test.run();
+        bool passed = failureCount() == before;
+        if (!passed) failedCases++;
+        std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", test.name);
+    }
+    std::printf("%zu tests, %d failed\n", registry().size(), failedCases);
+    return failedCases == 0 ? 0 : 1;
+}
+
+} // namespace ShaderlayTest
+
+#define TEST(name)                                                           \
+    static void name();                                                      \
+    static ::ShaderlayTest::Registrar name##Registrar(#name, name);          \
+    static void name()
+
+#define CHECK(condition)                                                     \
+    do {                                                                     \
+        if (!(condition)) {                                                  \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,     \
+                        #condition);                                         \
+            ::ShaderlayTest::failureCount()++;                               \
+        }                                                                    \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                           \
+    do {                                                                     \
+        auto shaderlayActual = (actual);                                     \
+        auto shaderlayExpected = (expected);                                 \
+        if (!(shaderlayActual == shaderlayExpected)) {                       \
+            std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",    \
+                        __FILE__, __LINE__, #actual, #expected,              \
+                        static_cast<long long>(shaderlayActual),             \
+                        static_cast<long long>(shaderlayExpected));          \
+            ::ShaderlayTest::failureCount()++;                               \
+        }                                                                    \
+    } while (0)
+
+#define CHECK_CONTAINS(haystack, needle) CHECK(std::string(haystack).find(needle) != std::string::npos)
+
+#define CHECK_NOT_CONTAINS(haystack, needle) CHECK(std::string(haystack).find(needle) == std::string::npos)
\ No newline at end of file
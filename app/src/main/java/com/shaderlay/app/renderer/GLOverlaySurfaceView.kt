@@ -2,9 +2,13 @@ package com.shaderlay.app.renderer
 
 import android.content.Context
 import android.graphics.PixelFormat
+import android.net.Uri
 import android.opengl.GLSurfaceView
 import android.util.AttributeSet
 import android.util.Log
+import com.shaderlay.app.shader.ExternalShaderManager
+import com.shaderlay.app.shader.NativeShaderCompiler
+import com.shaderlay.app.shader.ShaderManager
 
 class GLOverlaySurfaceView @JvmOverloads constructor(
     context: Context,
@@ -13,10 +17,16 @@ class GLOverlaySurfaceView @JvmOverloads constructor(
 
     companion object {
         private const val TAG = "GLOverlaySurfaceView"
+
+        // Stand-in chain that runs a preset's final pass on its own
+        private const val PREVIEW_PRESET = "shaders = 1\nshader0 = preview.slang\n"
     }
 
     private val shaderRenderer: ShaderRenderer
 
+    // Background preset compilation; needs no GL context
+    private val shaderManager by lazy { ShaderManager(context) }
+
     init {
         Log.d(TAG, "Initializing GLOverlaySurfaceView")
 
@@ -43,13 +53,111 @@ class GLOverlaySurfaceView @JvmOverloads constructor(
 
     fun updateShader(shaderName: String) {
         queueEvent {
+            shaderRenderer.clearPresetChain()
             shaderRenderer.loadShader(shaderName)
+
+            // Static overlays only redraw on resize or explicit changes
+            renderMode = if (shaderRenderer.needsContinuousRendering()) {
+                RENDERMODE_CONTINUOUSLY
+            } else {
+                RENDERMODE_WHEN_DIRTY
+            }
+            requestRender()
         }
     }
 
+    fun updatePresetChain(
+        presetContent: String,
+        passSources: Array<String>,
+        precompiled: Boolean = false,
+        textures: List<NativeShaderCompiler.LookupTexture> = emptyList()
+    ) {
+        queueEvent {
+            shaderRenderer.loadPresetChain(presetContent, passSources, precompiled, textures)
+            renderMode = if (shaderRenderer.needsContinuousRendering()) {
+                RENDERMODE_CONTINUOUSLY
+            } else {
+                RENDERMODE_WHEN_DIRTY
+            }
+            requestRender()
+        }
+    }
+
+    /**
+     * Load an external preset or shader: its files are read and compiled on
+     * background threads. The final pass is compiled first and shown on its
+     * own as a preview; the whole chain replaces it once every pass has
+     * compiled.
+     */
+    fun loadExternalPreset(uri: Uri, packPreset: String? = null) {
+        // Tiered shader packs are sized for the overlay as it is now
+        val viewWidth = width
+        val viewHeight = height
+        Thread {
+            val manager = ExternalShaderManager(context)
+            val preset = manager.resolvePreset(
+                uri,
+                shaderRenderer.glRenderer,
+                viewWidth,
+                viewHeight,
+                packPreset
+            )
+            if (preset == null) {
+                Log.e(TAG, "Failed to resolve preset: $uri")
+                return@Thread
+            }
+
+            // Decoded here rather than on the GL thread
+            val textures = manager.decodeTextures(preset.textures)
+            val preview = previewPreset(preset)
+            val compiled = arrayOfNulls<String>(preset.passSources.size)
+            val finalPass = preset.passSources.size - 1
+            val ticket = shaderManager.compilePresetAsync(
+                preset.content,
+                preset.passSources,
+                object : NativeShaderCompiler.CompileListener {
+                    override fun onPassCompiled(ticket: Long, passIndex: Int, fragmentSource: String) {
+                        compiled[passIndex] = fragmentSource
+                        if (passIndex == finalPass && finalPass > 0) {
+                            updatePresetChain(preview, arrayOf(fragmentSource), true, textures)
+                        }
+                    }
+
+                    override fun onJobFinished(ticket: Long, status: Int, message: String?) {
+                        when (status) {
+                            NativeShaderCompiler.COMPILE_COMPLETED -> {
+                                Log.d(TAG, "Preset ${preset.name} compiled")
+                                updatePresetChain(
+                                    preset.content,
+                                    compiled.map { it ?: "" }.toTypedArray(),
+                                    true,
+                                    textures
+                                )
+                            }
+                            NativeShaderCompiler.COMPILE_FAILED ->
+                                Log.e(TAG, "Failed to compile preset ${preset.name}: $message")
+                            else -> Log.d(TAG, "Compile of ${preset.name} superseded")
+                        }
+                    }
+                }
+            )
+            if (ticket == 0L) {
+                Log.e(TAG, "Failed to submit preset ${preset.name}")
+            }
+        }.start()
+    }
+
+    // The preview keeps the preset's texture declarations, so its final pass samples the same LUTs
+    private fun previewPreset(preset: ExternalShaderManager.ResolvedPreset): String {
+        val keys = setOf("textures") + preset.textures.keys.flatMap { listOf(it, "${it}_linear") }
+        val declarations = preset.content.lines().filter { it.substringBefore('=').trim() in keys }
+        return PREVIEW_PRESET + declarations.joinToString("") { "${it.trim()}\n" }
+    }
+
     fun updateOpacity(opacity: Float) {
         queueEvent {
             shaderRenderer.setOpacity(opacity)
+            requestRender()
         }
     }
 
@@ -61,6 +169,7 @@ class GLOverlaySurfaceView @JvmOverloads constructor(
 
     fun onDestroy() {
         Log.d(TAG, "Destroying GLOverlaySurfaceView")
+        shaderManager.cancelPresetCompile()
 
         queueEvent {
             shaderRenderer.cleanup()
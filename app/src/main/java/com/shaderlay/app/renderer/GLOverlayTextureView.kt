@@ -94,6 +94,10 @@ class GLOverlayTextureView @JvmOverloads constructor(
     ) : Thread("GLRenderThread") {
 
         private var running = false
+
+        // Set when a static overlay needs one more frame
+        @Volatile
+        private var dirty = true
         private var egl: EGL10? = null
         private var eglDisplay: EGLDisplay? = null
         private var eglContext: EGLContext? = null
@@ -118,8 +122,10 @@ class GLOverlayTextureView @JvmOverloads constructor(
                 val currentTime = System.currentTimeMillis()
                 val deltaTime = currentTime - lastFrameTime
 
-                // Target 60 FPS (16.67ms per frame)
-                if (deltaTime >= 16) {
+                // Target 60 FPS (16.67ms per frame); static overlays only on change
+                if (deltaTime >= 16 && (dirty || renderer.needsContinuousRendering())) {
+                    dirty = false
+
                     // Render frame
                     renderer.onDrawFrame(null)
 
@@ -221,14 +227,17 @@ class GLOverlayTextureView @JvmOverloads constructor(
             width = newWidth
             height = newHeight
             renderer.onSurfaceChanged(null, width, height)
+            dirty = true
         }
 
         fun updateShader(shaderName: String) {
             renderer.loadShader(shaderName)
+            dirty = true
         }
 
         fun updateOpacity(opacity: Float) {
             renderer.setOpacity(opacity)
+            dirty = true
         }
 
         fun updatePerformanceMode(mode: ShaderRenderer.PerformanceMode) {
@@ -5,6 +5,7 @@ import android.opengl.GLES20
 import android.opengl.GLSurfaceView
 import android.opengl.Matrix
 import android.util.Log
+import com.shaderlay.app.shader.NativeShaderCompiler
 import com.shaderlay.app.shader.ShaderManager
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
@@ -46,6 +47,7 @@ class ShaderRenderer(private val context: Context) : GLSurfaceView.Renderer {
     }
 
     private var shaderManager: ShaderManager? = null
+    private val nativeCompiler = NativeShaderCompiler()
     private var vertexBuffer: FloatBuffer? = null
     private var textureBuffer: FloatBuffer? = null
 
@@ -63,14 +65,35 @@ class ShaderRenderer(private val context: Context) : GLSurfaceView.Renderer {
 
     private var currentOpacity = 1.0f
     private var currentShader = "red_test"
+    private var outputDependency = NativeShaderCompiler.OUTPUT_TIME_DEPENDENT
     private var performanceMode = PerformanceMode.BALANCED
     private var startTime = 0L
     private var frameCount = 0
     private var lastFpsTime = 0L
 
+    // Native preset chain, rebuilt from these whenever the context is recreated
+    private var chainContent: String? = null
+    private var chainSources: Array<String>? = null
+    private var chainTextures: List<NativeShaderCompiler.LookupTexture> = emptyList()
+    private var chainPrecompiled = false
+    private var chainActive = false
+    private var chainDependency = NativeShaderCompiler.OUTPUT_TIME_DEPENDENT
+    private var surfaceWidth = 0
+    private var surfaceHeight = 0
+
+    // GL_RENDERER of the current context, read off the GL thread to pick shader tiers
+    @Volatile
+    var glRenderer = ""
+        private set
+
     override fun onSurfaceCreated(gl: GL10?, config: EGLConfig?) {
         Log.d(TAG, "onSurfaceCreated")
 
+        // Objects of a previous context are gone with it
+        nativeCompiler.releasePresetChain(true)
+        chainActive = false
+        glRenderer = GLES20.glGetString(GLES20.GL_RENDERER) ?: ""
+
         // Enable blending for shader transparency
         GLES20.glEnable(GLES20.GL_BLEND)
         GLES20.glBlendFunc(GLES20.GL_SRC_ALPHA, GLES20.GL_ONE_MINUS_SRC_ALPHA)
@@ -96,6 +119,14 @@ class ShaderRenderer(private val context: Context) : GLSurfaceView.Renderer {
         Log.d(TAG, "onSurfaceChanged: ${width}x${height}")
 
         GLES20.glViewport(0, 0, width, height)
+        surfaceWidth = width
+        surfaceHeight = height
+
+        if (chainActive) {
+            chainActive = nativeCompiler.resizePresetChain(width, height)
+        } else if (chainContent != null) {
+            buildChain()
+        }
 
         // Set up projection matrix
         val ratio = width.toFloat() / height.toFloat()
@@ -115,10 +146,25 @@ class ShaderRenderer(private val context: Context) : GLSurfaceView.Renderer {
     }
 
     override fun onDrawFrame(gl: GL10?) {
+        if (chainActive) {
+            if (chainDependency == NativeShaderCompiler.OUTPUT_TRANSPARENT) {
+                // Nothing visible to draw
+                GLES20.glClear(GLES20.GL_COLOR_BUFFER_BIT)
+                return
+            }
+
+            // The whole chain renders in a single native call
+            val timeSeconds = (System.currentTimeMillis() - startTime) / 1000.0f
+            nativeCompiler.renderPresetFrame(timeSeconds, currentOpacity)
+            updateFrameStats()
+            return
+        }
+
         // Clear the screen
         GLES20.glClear(GLES20.GL_COLOR_BUFFER_BIT)
 
-        if (shaderProgram == 0) return
+        // Nothing visible to draw
+        if (shaderProgram == 0 || outputDependency == NativeShaderCompiler.OUTPUT_TRANSPARENT) return
 
         // Use shader program
         GLES20.glUseProgram(shaderProgram)
@@ -225,15 +271,13 @@ class ShaderRenderer(private val context: Context) : GLSurfaceView.Renderer {
         Log.d(TAG, "Loading shader: $shaderName")
 
         shaderManager?.let { manager ->
+            // ShaderManager owns and caches the programs; deleting the
+            // previous one here would force a recompile when switching back
             val program = manager.createShaderProgram(shaderName)
             if (program != 0) {
-                // Clean up old program
-                if (shaderProgram != 0) {
-                    GLES20.glDeleteProgram(shaderProgram)
-                }
-
                 shaderProgram = program
                 currentShader = shaderName
+                outputDependency = manager.getOutputDependency(shaderName)
 
                 // Get shader attribute and uniform handles
                 vertexHandle = GLES20.glGetAttribLocation(shaderProgram, "a_Position")
@@ -243,6 +287,12 @@ class ShaderRenderer(private val context: Context) : GLSurfaceView.Renderer {
                 timeHandle = GLES20.glGetUniformLocation(shaderProgram, "u_Time")
                 resolutionHandle = GLES20.glGetUniformLocation(shaderProgram, "u_Resolution")
 
+                // A cached program may predate the last resize
+                if (resolutionHandle != 0 && surfaceWidth > 0) {
+                    GLES20.glUseProgram(shaderProgram)
+                    GLES20.glUniform2f(resolutionHandle, surfaceWidth.toFloat(), surfaceHeight.toFloat())
+                }
+
                 Log.d(TAG, "Shader loaded successfully: $shaderName")
             } else {
                 Log.e(TAG, "Failed to load shader: $shaderName")
@@ -250,6 +300,68 @@ class ShaderRenderer(private val context: Context) : GLSurfaceView.Renderer {
         }
     }
 
+    /**
+     * Switches to a native multi-pass preset chain. passSources holds one
+     * slang source per preset pass, or its compiled fragment shader when
+     * precompiled is set; textures are the decoded LUTs the preset
+     * declares. Must run on the GL thread.
+     */
+    fun loadPresetChain(
+        presetContent: String,
+        passSources: Array<String>,
+        precompiled: Boolean = false,
+        textures: List<NativeShaderCompiler.LookupTexture> = emptyList()
+    ): Boolean {
+        chainContent = presetContent
+        chainSources = passSources
+        chainTextures = textures
+        chainPrecompiled = precompiled
+        chainDependency = nativeCompiler.analyzePresetDependency(presetContent, passSources)?.get(0)
+            ?: NativeShaderCompiler.OUTPUT_TIME_DEPENDENT
+        if (surfaceWidth == 0 || surfaceHeight == 0) {
+            // Built once the surface size is known
+            return true
+        }
+        return buildChain()
+    }
+
+    fun clearPresetChain() {
+        nativeCompiler.releasePresetChain(false)
+        chainActive = false
+        chainContent = null
+        chainSources = null
+        chainTextures = emptyList()
+        chainDependency = NativeShaderCompiler.OUTPUT_TIME_DEPENDENT
+    }
+
+    private fun buildChain(): Boolean {
+        val content = chainContent ?: return false
+        val sources = chainSources ?: return false
+
+        val textures = chainTextures
+        chainActive = nativeCompiler.buildPresetChain(
+            content, sources, chainPrecompiled, surfaceWidth, surfaceHeight, false,
+            textures.map { it.name }.toTypedArray(),
+            textures.flatMap { listOf(it.width, it.height) }.toIntArray(),
+            textures.map { it.pixels }.toTypedArray()
+        )
+        if (!chainActive) {
+            Log.e(TAG, "Failed to build preset chain, using single shader")
+        }
+        return chainActive
+    }
+
+    /**
+     * Whether the current shader's output changes from frame to frame.
+     * Otherwise a redraw is only needed after a resize or setting change.
+     */
+    fun needsContinuousRendering(): Boolean {
+        // A chain waiting for the surface size is judged as if it were built
+        val chainPending = chainContent != null && (surfaceWidth == 0 || surfaceHeight == 0)
+        val dependency = if (chainActive || chainPending) chainDependency else outputDependency
+        return dependency == NativeShaderCompiler.OUTPUT_TIME_DEPENDENT
+    }
+
     fun setOpacity(opacity: Float) {
         currentOpacity = opacity.coerceIn(0.0f, 1.0f)
         Log.d(TAG, "Opacity set to: $currentOpacity")
@@ -263,10 +375,10 @@ class ShaderRenderer(private val context: Context) : GLSurfaceView.Renderer {
     fun cleanup() {
         Log.d(TAG, "Cleaning up ShaderRenderer")
 
-        if (shaderProgram != 0) {
-            GLES20.glDeleteProgram(shaderProgram)
-            shaderProgram = 0
-        }
+        clearPresetChain()
+
+        // Deleted by shaderManager.cleanup()
+        shaderProgram = 0
 
         shaderManager?.cleanup()
         shaderManager = null
@@ -8,12 +8,14 @@ import android.app.Service
 import android.content.Context
 import android.content.Intent
 import android.graphics.PixelFormat
+import android.net.Uri
 import android.os.Build
 import android.os.IBinder
 import android.util.Log
 import android.view.Gravity
 import android.view.WindowManager
 import androidx.core.app.NotificationCompat
+import androidx.preference.PreferenceManager
 import com.shaderlay.app.R
 import com.shaderlay.app.renderer.GLOverlaySurfaceView
 import com.shaderlay.app.ui.MainActivity
@@ -95,6 +97,8 @@ class OverlayService : Service() {
             windowManager?.addView(overlayView, layoutParams)
             isOverlayActive = true
 
+            applyExternalShader()
+
             // Start foreground service
             startForeground(NOTIFICATION_ID, createNotification())
 
@@ -106,6 +110,16 @@ class OverlayService : Service() {
         }
     }
 
+    private fun applyExternalShader() {
+        val prefs = PreferenceManager.getDefaultSharedPreferences(this)
+        if (prefs.getString("shader_selection", null) != "external") return
+
+        val shaderUri = prefs.getString("selected_shader_uri", null) ?: return
+        val packPreset = prefs.getString("selected_pack_preset", null)
+        Log.d(TAG, "Loading external shader: $shaderUri ${packPreset ?: ""}")
+        overlayView?.loadExternalPreset(Uri.parse(shaderUri), packPreset)
+    }
+
     private fun stopOverlay() {
         if (!isOverlayActive) {
             Log.d(TAG, "Overlay not active")
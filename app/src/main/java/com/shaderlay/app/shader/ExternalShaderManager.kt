@@ -1,18 +1,32 @@
 package com.shaderlay.app.shader
 
 import android.content.Context
+import android.graphics.Bitmap
+import android.graphics.BitmapFactory
 import android.net.Uri
 import android.util.Log
 import androidx.documentfile.provider.DocumentFile
 import java.io.BufferedReader
 import java.io.InputStreamReader
+import java.nio.ByteBuffer
 
 class ExternalShaderManager(private val context: Context) {
 
     companion object {
         private const val TAG = "ExternalShaderManager"
+        private const val PRESET_INDEX_PREFIX = "preset_index_"
+
+        // Tier words in directory and preset names, with their tiers
+        private val TIER_NAMES = listOf("fast", "advanced", "hd")
+        private val TIER_LEVELS = listOf(
+            NativeShaderCompiler.TIER_FAST,
+            NativeShaderCompiler.TIER_ADVANCED,
+            NativeShaderCompiler.TIER_HD
+        )
     }
 
+    private val nativeCompiler = NativeShaderCompiler()
+
     data class ExternalShader(
         val name: String,
         val uri: Uri,
@@ -21,6 +35,47 @@ class ExternalShaderManager(private val context: Context) {
         val shaderPaths: List<String> = emptyList()
     )
 
+    data class IndexedPreset(
+        val path: String,
+        val passCount: Int
+    )
+
+    // A preset together with the source of each of its passes and the
+    // encoded images of its LUT textures, keyed by texture name
+    class ResolvedPreset(
+        val name: String,
+        val content: String,
+        val passSources: Array<String>,
+        val textures: Map<String, ByteArray> = emptyMap()
+    )
+
+    /**
+     * A zipped shader pack opened in place. Each pack has its own native
+     * handle, so packs can be read from any thread; close it when done.
+     */
+    inner class ShaderPack internal constructor(
+        private val handle: Long,
+        val presets: List<String>
+    ) : java.io.Closeable {
+
+        fun readText(presetPath: String, relativePath: String): String? {
+            return nativeCompiler.readArchiveText(handle, presetPath, relativePath)
+        }
+
+        fun readBytes(presetPath: String, relativePath: String): ByteArray? {
+            return nativeCompiler.readArchiveBytes(handle, presetPath, relativePath)
+        }
+
+        // Refresh the persistent index of this pack's presets
+        fun updateIndex(packKey: String, indexPath: String): IntArray? {
+            return nativeCompiler.updatePackPresetIndex(handle, packKey, indexPath)
+        }
+
+        override fun close() {
+            nativeCompiler.closeShaderArchive(handle)
+        }
+    }
+
     fun loadShaderFromUri(uri: Uri): ExternalShader? {
         return try {
             val documentFile = DocumentFile.fromSingleUri(context, uri)
@@ -101,8 +156,10 @@ class ExternalShaderManager(private val context: Context) {
 
         val key = parts[0].trim()
         val value = parts[1].trim().removeSurrounding("\"")
+        preset.values[key] = value
 
         when {
+            key == "textures" -> parseTextureNames(value, preset)
             key == "shaders" -> parseShaderCount(value, preset)
             key.startsWith("shader") && !key.contains("_") -> parseShaderPath(key, value, preset)
             key.startsWith("filter_linear") -> parseFilterLinear(key, value, preset)
@@ -120,6 +177,11 @@ class ExternalShaderManager(private val context: Context) {
         preset.shaderPaths[index] = value
     }
 
+    private fun parseTextureNames(value: String, preset: ParsedPreset) {
+        preset.textureNames.clear()
+        preset.textureNames.addAll(value.split(';').map { it.trim() }.filter { it.isNotEmpty() })
+    }
+
     private fun parseFilterLinear(key: String, value: String, preset: ParsedPreset) {
         val index = key.removePrefix("filter_linear").toIntOrNull() ?: return
         preset.filterLinear[index] = value.toBoolean()
@@ -140,8 +202,57 @@ class ExternalShaderManager(private val context: Context) {
         val shaderPaths: MutableMap<Int, String> = mutableMapOf(),
         val filterLinear: MutableMap<Int, Boolean> = mutableMapOf(),
         val scaleTypes: MutableMap<Int, String> = mutableMapOf(),
-        val scales: MutableMap<Int, Float> = mutableMapOf()
-    )
+        val scales: MutableMap<Int, Float> = mutableMapOf(),
+        val textureNames: MutableList<String> = mutableListOf(),
+        val values: MutableMap<String, String> = mutableMapOf()
+    ) {
+        // Image path of each LUT texture; the path line may come before
+        // or after the textures line
+        val texturePaths: Map<String, String>
+            get() = textureNames.mapNotNull { name -> values[name]?.let { name to it } }.toMap()
+    }
+
+    /**
+     * Read a preset and every pass it references, ready for
+     * ShaderManager.compilePresetAsync. A lone .slang file becomes a
+     * single-pass preset and a .zip shader pack yields one of its presets;
+     * for a look shipped in tiers, the heaviest one the GPU named by
+     * renderer (GL_RENDERER) sustains at width x height. packPreset names
+     * the preset picked inside a pack. Reads storage; keep it off the UI
+     * and GL threads.
+     */
+    fun resolvePreset(
+        uri: Uri,
+        renderer: String = "",
+        width: Int = 0,
+        height: Int = 0,
+        packPreset: String? = null
+    ): ResolvedPreset? {
+        val fileName = DocumentFile.fromSingleUri(context, uri)?.name ?: return null
+        if (fileName.endsWith(".zip")) {
+            return resolvePackPreset(uri, fileName, renderer, width, height, packPreset)
+        }
+
+        val shader = loadShaderFromUri(uri) ?: return null
+
+        if (!shader.isPreset) {
+            val source = shader.shaderPaths.firstOrNull() ?: return null
+            val content = "shaders = 1\nshader0 = \"${shader.name}.slang\"\n"
+            return ResolvedPreset(shader.name, content, arrayOf(source))
+        }
+
+        val content = shader.presetContent ?: return null
+        val preset = parseExternalPreset(content, uri) ?: return null
+        val passCount = maxOf(preset.shaderCount, (preset.shaderPaths.keys.maxOrNull() ?: -1) + 1)
+        val sources = (0 until passCount).map { index ->
+            val path = preset.shaderPaths[index]
+            path?.let { loadShaderContentFromPreset(uri, it) } ?: run {
+                Log.e(TAG, "Missing source for pass $index of ${shader.name}: $path")
+                return null
+            }
+        }
+        return ResolvedPreset(shader.name, content, sources.toTypedArray())
+    }
 
     fun loadShaderContentFromPreset(presetUri: Uri, shaderPath: String): String? {
         return try {
@@ -157,6 +268,212 @@ class ExternalShaderManager(private val context: Context) {
         }
     }
 
+    /**
+     * Open a zipped shader pack in place, or null if the archive could not
+     * be indexed.
+     */
+    fun openShaderPack(uri: Uri): ShaderPack? {
+        return try {
+            val descriptor = context.contentResolver.openFileDescriptor(uri, "r") ?: return null
+            // Native side takes ownership of the detached descriptor
+            val handle = nativeCompiler.openShaderArchive(descriptor.detachFd())
+            if (handle == 0L) {
+                Log.e(TAG, "Failed to open shader pack: $uri")
+                return null
+            }
+            val presets = nativeCompiler.listArchiveEntries(handle, ".slangp")?.toList() ?: emptyList()
+            ShaderPack(handle, presets)
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to open shader pack: $uri", e)
+            null
+        }
+    }
+
+    fun loadShaderContentFromPack(pack: ShaderPack, presetPath: String, shaderPath: String): String? {
+        return pack.readText(presetPath, shaderPath)
+    }
+
+    /**
+     * Decode the LUT images of a resolved preset for the native chain.
+     * Pixels stay unpremultiplied, as shaders expect LUT values verbatim.
+     */
+    fun decodeTextures(textures: Map<String, ByteArray>): List<NativeShaderCompiler.LookupTexture> {
+        val options = BitmapFactory.Options().apply {
+            inPreferredConfig = Bitmap.Config.ARGB_8888
+            inPremultiplied = false
+        }
+        return textures.mapNotNull { (name, encoded) ->
+            val bitmap = BitmapFactory.decodeByteArray(encoded, 0, encoded.size, options) ?: run {
+                Log.w(TAG, "Failed to decode texture $name")
+                return@mapNotNull null
+            }
+            try {
+                // ARGB_8888 is laid out as RGBA bytes
+                val pixels = ByteBuffer.allocate(bitmap.byteCount)
+                bitmap.copyPixelsToBuffer(pixels)
+                NativeShaderCompiler.LookupTexture(name, bitmap.width, bitmap.height, pixels.array())
+            } finally {
+                bitmap.recycle()
+            }
+        }
+    }
+
+    // Encoded image of a LUT texture, resolved relative to its preset
+    fun loadTextureFromPack(pack: ShaderPack, presetPath: String, texturePath: String): ByteArray? {
+        return pack.readBytes(presetPath, texturePath)
+    }
+
+    // Pass sources of a preset in a shader pack, null if any is missing
+    private fun loadPackPassSources(pack: ShaderPack, presetPath: String, preset: ParsedPreset): Array<String>? {
+        val passCount = maxOf(preset.shaderCount, (preset.shaderPaths.keys.maxOrNull() ?: -1) + 1)
+        val sources = (0 until passCount).map { index ->
+            val path = preset.shaderPaths[index]
+            path?.let { loadShaderContentFromPack(pack, presetPath, it) } ?: run {
+                Log.e(TAG, "Missing source for pass $index of $presetPath: $path")
+                return null
+            }
+        }
+        return sources.toTypedArray()
+    }
+
+    // LUT images of a preset in a shader pack; a missing image is logged
+    // and left out, the pass then samples an unbound texture
+    private fun loadPackTextures(pack: ShaderPack, presetPath: String, preset: ParsedPreset): Map<String, ByteArray> {
+        return preset.texturePaths.mapNotNull { (name, path) ->
+            loadTextureFromPack(pack, presetPath, path)?.let { name to it } ?: run {
+                Log.w(TAG, "Missing texture $name of $presetPath: $path")
+                null
+            }
+        }.toMap()
+    }
+
+    // The pack is read completely and closed again; presets are resolved relative to it
+    private fun resolvePackPreset(
+        uri: Uri,
+        fileName: String,
+        renderer: String,
+        width: Int,
+        height: Int,
+        packPreset: String?
+    ): ResolvedPreset? {
+        return openShaderPack(uri)?.use { pack ->
+            val selected = packPreset?.takeIf { it in pack.presets } ?: pack.presets.firstOrNull() ?: run {
+                Log.w(TAG, "No presets in shader pack: $fileName")
+                return null
+            }
+            val tierPresets = findTierPresets(pack, selected)
+            val presetPath = if (tierPresets.size > 1 && renderer.isNotEmpty() && width > 0 && height > 0) {
+                val tier = selectPackTier(pack, tierPresets, renderer, width, height)
+                if (tier < 0) {
+                    Log.w(TAG, "No tier of $selected fits the frame budget on $renderer, using the lightest")
+                }
+                tierPresets[maxOf(tier, 0)]
+            } else {
+                selected
+            }
+            val content = loadShaderContentFromPack(pack, "", presetPath) ?: return null
+            val preset = parseExternalPreset(content, Uri.EMPTY) ?: return null
+            val sources = loadPackPassSources(pack, presetPath, preset) ?: return null
+            val textures = loadPackTextures(pack, presetPath, preset)
+            val name = presetPath.substringAfterLast('/').removeSuffix(".slangp")
+            ResolvedPreset(name, content, sources, textures)
+        }
+    }
+
+    /**
+     * Estimated per-frame cost of a preset in a shader pack. The overlay
+     * has no game frame, so the viewport doubles as the source size.
+     */
+    fun estimatePackPresetCost(pack: ShaderPack, presetPath: String, width: Int, height: Int): Float? {
+        val content = loadShaderContentFromPack(pack, "", presetPath) ?: return null
+        val preset = parseExternalPreset(content, Uri.EMPTY) ?: return null
+        val sources = loadPackPassSources(pack, presetPath, preset) ?: return null
+        return nativeCompiler.estimatePresetCost(content, sources, width, height, width, height)?.get(0)
+    }
+
+    /**
+     * Tier variants of the selected preset, lightest first: presets in the
+     * same directory whose names only differ in a tier word, as in
+     * crt-guest-fast-ntsc and crt-guest-advanced-ntsc. A preset's tier is
+     * the directory its passes live in, as in shaders/guest/fast. Only the
+     * variants are read. Empty if the selected preset is not tiered.
+     */
+    private fun findTierPresets(pack: ShaderPack, selected: String): List<String> {
+        val directory = selected.substringBeforeLast('/', "")
+        val stem = presetStem(selected)
+        val variants = pack.presets.filter {
+            it.substringBeforeLast('/', "") == directory && presetStem(it) == stem
+        }
+
+        val byTier = sortedMapOf<Int, String>()
+        // The selected preset wins over another variant of the same tier
+        for (presetPath in listOf(selected) + (variants - selected)) {
+            val content = loadShaderContentFromPack(pack, "", presetPath) ?: continue
+            val preset = parseExternalPreset(content, Uri.EMPTY) ?: continue
+            val tier = presetTier(preset) ?: continue
+            byTier.putIfAbsent(tier, presetPath)
+        }
+        return if (selected in byTier.values) byTier.values.toList() else emptyList()
+    }
+
+    // Preset file name without its tier word, shared by all tiers of a look
+    private fun presetStem(presetPath: String): String {
+        return presetPath.substringAfterLast('/')
+            .removeSuffix(".slangp")
+            .split('-', '_')
+            .filterNot { it in TIER_NAMES }
+            .joinToString("-")
+    }
+
+    // Tier whose directory holds most of the preset's passes, if any
+    private fun presetTier(preset: ParsedPreset): Int? {
+        val votes = TIER_NAMES.zip(TIER_LEVELS).map { (directory, tier) ->
+            tier to preset.shaderPaths.values.count { directory in it.split('/').dropLast(1) }
+        }
+        return votes.filter { it.second > 0 }.maxByOrNull { it.second }?.first
+    }
+
+    /**
+     * Pick the heaviest of tierPresets (lightest first) that the GPU named
+     * by renderer (GL_RENDERER) can run within the frame budget, or -1 if
+     * none can.
+     */
+    fun selectPackTier(pack: ShaderPack, tierPresets: List<String>, renderer: String, width: Int, height: Int): Int {
+        val costs = tierPresets.map { estimatePackPresetCost(pack, it, width, height) ?: Float.MAX_VALUE }
+        return nativeCompiler.selectShaderTier(
+            costs.toFloatArray(),
+            renderer,
+            NativeShaderCompiler.DEFAULT_FRAME_BUDGET_MS
+        )
+    }
+
+    /**
+     * Presets of the shader pack at uri, as the preset picker lists them.
+     * The pack's index persists across runs; only presets whose entry or
+     * referenced files changed since are re-parsed. Reads storage; keep it
+     * off the UI thread.
+     */
+    fun indexShaderPack(uri: Uri): List<IndexedPreset> {
+        return openShaderPack(uri)?.use { pack ->
+            try {
+                val packKey = uri.toString()
+                val indexFile = PRESET_INDEX_PREFIX + Integer.toHexString(packKey.hashCode()) + ".bin"
+                val indexPath = java.io.File(context.filesDir, indexFile).absolutePath
+                val stats = pack.updateIndex(packKey, indexPath) ?: return emptyList()
+                Log.d(TAG, "Indexed ${stats[0]} presets, ${stats[1]} re-parsed")
+
+                val paths = nativeCompiler.getIndexedPresetPaths() ?: return emptyList()
+                val passCounts = nativeCompiler.getIndexedPresetPassCounts() ?: return emptyList()
+                paths.indices
+                    .filter { passCounts[it] > 0 }
+                    .map { IndexedPreset(paths[it], passCounts[it]) }
+            } catch (e: Exception) {
+                Log.e(TAG, "Failed to index shader pack: $uri", e)
+                emptyList()
+            }
+        } ?: emptyList()
+    }
+
     private fun getParentUri(uri: Uri): Uri? {
         return try {
             val documentFile = DocumentFile.fromSingleUri(context, uri)
@@ -181,6 +498,7 @@ class ExternalShaderManager(private val context: Context) {
             "text/plain",
             "text/*",
             "application/octet-stream",
+            "application/zip",
             "*/*"
         )
     }
@@ -9,8 +9,58 @@ class NativeShaderCompiler {
 
         const val SHADER_TYPE_VERTEX = 0
         const val SHADER_TYPE_FRAGMENT = 1
+
+        // Indices into getLastPrecisionReport()
+        const val PRECISION_VARIABLES = 0
+        const val PRECISION_HIGHP = 1
+        const val PRECISION_MEDIUMP = 2
+        const val PRECISION_LOWP = 3
+        const val PRECISION_DOWNGRADED = 4
+        const val PRECISION_UPGRADED = 5
+
+        // Output dependency classes, cheapest to redraw first
+        const val OUTPUT_TRANSPARENT = 0
+        const val OUTPUT_CONSTANT = 1
+        const val OUTPUT_RESOLUTION_ONLY = 2
+        const val OUTPUT_TIME_DEPENDENT = 3
+
+        // Status codes passed to CompileListener.onJobFinished
+        const val COMPILE_COMPLETED = 0
+        const val COMPILE_CANCELLED = 1
+        const val COMPILE_FAILED = 2
+
+        // Priorities for submitPresetCompile; higher runs first
+        const val PRIORITY_BACKGROUND = 0
+        const val PRIORITY_VISIBLE = 10
+
+        // Tiers passed to selectShaderTier, lightest first
+        const val TIER_FAST = 0
+        const val TIER_ADVANCED = 1
+        const val TIER_HD = 2
+
+        // GPU time the overlay may use per frame; the rest belongs to the app beneath
+        const val DEFAULT_FRAME_BUDGET_MS = 8.0f
+    }
+
+    /**
+     * Callbacks from the native compile worker thread. The final pass is
+     * delivered first so a preview frame can be shown before the chain
+     * completes.
+     */
+    interface CompileListener {
+        fun onPassCompiled(ticket: Long, passIndex: Int, fragmentSource: String)
+        // message describes a COMPILE_FAILED status and is null otherwise
+        fun onJobFinished(ticket: Long, status: Int, message: String?)
     }
 
+    // Decoded LUT of a preset, tightly packed RGBA rows; name as in the preset's textures list
+    class LookupTexture(
+        val name: String,
+        val width: Int,
+        val height: Int,
+        val pixels: ByteArray
+    )
+
     external fun initialize(): Boolean
     external fun cleanup()
 
@@ -18,4 +68,82 @@ class NativeShaderCompiler {
     external fun parseSlangPreset(presetContent: String): Boolean
     external fun getShaderSource(shaderPath: String): String?
     external fun validateShader(source: String, type: Int): Boolean
+    external fun getLastPrecisionReport(): IntArray?
+
+    // Shader pack archives (.zip), read in place without extraction. Open
+    // returns a handle (0 on failure) that the other calls take, so packs
+    // can be read from several threads at once
+    external fun openShaderArchive(fd: Int): Long
+    external fun closeShaderArchive(handle: Long)
+    external fun listArchiveEntries(handle: Long, suffix: String): Array<String>?
+    external fun readArchiveText(handle: Long, presetPath: String, relativePath: String): String?
+    external fun readArchiveBytes(handle: Long, presetPath: String, relativePath: String): ByteArray?
+
+    // Persistent index of the presets in an open shader pack, keyed by
+    // packKey; returns [scanned, reparsed, reused, removed]
+    external fun updatePackPresetIndex(handle: Long, packKey: String, indexPath: String): IntArray?
+    external fun getIndexedPresetPaths(): Array<String>?
+    external fun getIndexedPresetPassCounts(): IntArray?
+
+    // Redraw requirements; analyzePresetDependency returns [preset, pass0, pass1, ...]
+    external fun analyzeOutputDependency(source: String): Int
+    external fun analyzePresetDependency(presetContent: String, passSources: Array<String>): IntArray?
+
+    // Asynchronous preset compilation of one source per pass; returns a ticket, 0 on failure
+    external fun submitPresetCompile(
+        presetContent: String,
+        passSources: Array<String>,
+        priority: Int,
+        listener: CompileListener
+    ): Long
+    external fun cancelCompile(ticket: Long): Boolean
+    external fun cancelAllCompilesExcept(ticket: Long)
+    // Scratch memory of the last finished job: [highWaterBytes, allocations, peakBytes, reservedBytes]
+    external fun getLastCompileArenaStats(): LongArray?
+
+    // Static GPU cost estimates in abstract units; estimatePassCost returns
+    // [textureFetches, aluOps, loopIterations, unitsPerPixel] and
+    // estimatePresetCost returns [frame, pass0, pass1, ...]
+    external fun estimatePassCost(source: String): FloatArray?
+    external fun estimatePresetCost(
+        presetContent: String,
+        passSources: Array<String>,
+        sourceWidth: Int,
+        sourceHeight: Int,
+        viewportWidth: Int,
+        viewportHeight: Int
+    ): FloatArray?
+    external fun estimateFrameTimeMs(frameCost: Float, renderer: String): Float
+    // Heaviest tier within the budget, or -1 if even the lightest is too slow
+    external fun selectShaderTier(frameCosts: FloatArray, renderer: String, frameBudgetMs: Float): Int
+
+    // Native multi-pass chain; call on the GL thread. precompiled skips
+    // compiling passSources that came from submitPresetCompile; headless
+    // records calls instead of issuing them. Texture i is named
+    // textureNames[i], sized textureSizes[2i] x textureSizes[2i + 1] and
+    // holds texturePixels[i]. Rebuilding reuses the passes and textures
+    // shared with the previous preset. getPresetChainStats returns
+    // [frames, passes, drawCalls, stateCalls, uniformCalls, lastCpuMs, averageCpuMs],
+    // getPresetChainBuildStats returns [passes, reusedPasses, reusedPrograms,
+    // compiledPrograms, reusedTargets, createdTargets, reusedTextures, createdTextures]
+    external fun buildPresetChain(
+        presetContent: String,
+        passSources: Array<String>,
+        precompiled: Boolean,
+        width: Int,
+        height: Int,
+        headless: Boolean,
+        textureNames: Array<String>,
+        textureSizes: IntArray,
+        texturePixels: Array<ByteArray>
+    ): Boolean
+    external fun resizePresetChain(width: Int, height: Int): Boolean
+    external fun renderPresetFrame(timeSeconds: Float, opacity: Float): Boolean
+    external fun releasePresetChain(contextLost: Boolean)
+    external fun getPresetChainStats(): FloatArray?
+    external fun getPresetChainBuildStats(): IntArray?
+
+    // Native log ring; stats are [written, rateLimited, overflowed]
+    external fun flushNativeLog()
+    external fun getNativeLogStats(): LongArray?
 }
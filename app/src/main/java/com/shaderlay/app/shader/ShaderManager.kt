@@ -11,10 +11,14 @@ class ShaderManager(private val context: Context) {
     }
 
     private val shaderCache = mutableMapOf<String, Int>()
+    private val outputDependencies = mutableMapOf<String, Int>()
     private val compilationCache = ShaderCache(context)
     private val nativeCompiler = NativeShaderCompiler()
     private val externalShaderManager = ExternalShaderManager(context)
 
+    // Ticket of the preset currently compiling in the background
+    private var activeCompileTicket = 0L
+
     // Store loaded external shaders
     private val externalShaders = mutableMapOf<String, ExternalShaderManager.ExternalShader>()
 
@@ -121,6 +125,13 @@ class ShaderManager(private val context: Context) {
 
             if (compiled != null) {
                 Log.d(TAG, "Compiled fragment shader with native compiler: $shaderName")
+                nativeCompiler.getLastPrecisionReport()?.let { report ->
+                    Log.d(
+                        TAG,
+                        "Precision for $shaderName: ${report[NativeShaderCompiler.PRECISION_DOWNGRADED]} of " +
+                            "${report[NativeShaderCompiler.PRECISION_VARIABLES]} variables downgraded"
+                    )
+                }
                 // Cache the compiled result
                 compilationCache.putCompiledShader(
                     originalShaderCode,
@@ -134,9 +145,44 @@ class ShaderManager(private val context: Context) {
             }
         }
 
+        outputDependencies[shaderName] = nativeCompiler.analyzeOutputDependency(finalShaderCode)
+
         return loadShader(GLES20.GL_FRAGMENT_SHADER, finalShaderCode)
     }
 
+    /**
+     * Compile a preset in the background, superseding any preset still
+     * compiling. Listener callbacks arrive on the native worker thread.
+     */
+    fun compilePresetAsync(
+        presetContent: String,
+        passSources: Array<String>,
+        listener: NativeShaderCompiler.CompileListener
+    ): Long {
+        val ticket = nativeCompiler.submitPresetCompile(
+            presetContent,
+            passSources,
+            NativeShaderCompiler.PRIORITY_VISIBLE,
+            listener
+        )
+        if (ticket != 0L) {
+            nativeCompiler.cancelAllCompilesExcept(ticket)
+            activeCompileTicket = ticket
+        }
+        return ticket
+    }
+
+    fun cancelPresetCompile() {
+        if (activeCompileTicket != 0L) {
+            nativeCompiler.cancelCompile(activeCompileTicket)
+            activeCompileTicket = 0L
+        }
+    }
+
+    fun getOutputDependency(shaderName: String): Int {
+        return outputDependencies[shaderName] ?: NativeShaderCompiler.OUTPUT_TIME_DEPENDENT
+    }
+
     private fun loadShader(type: Int, shaderCode: String): Int {
         val shader = GLES20.glCreateShader(type)
         if (shader == 0) {
@@ -14,11 +14,13 @@ import androidx.appcompat.app.AlertDialog
 import androidx.appcompat.app.AppCompatActivity
 import androidx.core.app.ActivityCompat
 import androidx.core.content.ContextCompat
+import androidx.documentfile.provider.DocumentFile
 import com.google.android.material.button.MaterialButton
 import com.google.android.material.materialswitch.MaterialSwitch
 import android.widget.TextView
 import com.shaderlay.app.R
 import com.shaderlay.app.service.OverlayService
+import com.shaderlay.app.shader.ExternalShaderManager
 
 class MainActivity : AppCompatActivity() {
 
@@ -258,7 +260,8 @@ class MainActivity : AppCompatActivity() {
             putExtra(Intent.EXTRA_MIME_TYPES, arrayOf(
                 "text/plain",
                 "text/*",
-                "application/octet-stream"
+                "application/octet-stream",
+                "application/zip"
             ))
         }
 
@@ -272,12 +275,53 @@ class MainActivity : AppCompatActivity() {
     private fun handleShaderFileSelection(uri: Uri) {
         Log.d(TAG, "Shader file selected: $uri")
 
+        val fileName = DocumentFile.fromSingleUri(this, uri)?.name ?: ""
+        if (fileName.endsWith(".zip")) {
+            choosePackPreset(uri)
+        } else {
+            applyShaderSelection(uri, null)
+        }
+    }
+
+    // A shader pack holds many presets; list them from the pack's index
+    private fun choosePackPreset(uri: Uri) {
+        Thread {
+            val presets = ExternalShaderManager(this).indexShaderPack(uri)
+            runOnUiThread {
+                if (isFinishing) return@runOnUiThread
+                when (presets.size) {
+                    0 -> Toast.makeText(this, "No presets found in shader pack", Toast.LENGTH_SHORT).show()
+                    1 -> applyShaderSelection(uri, presets[0].path)
+                    else -> {
+                        val names = presets.map { "${it.path.removeSuffix(".slangp")} (${it.passCount} passes)" }
+                        AlertDialog.Builder(this)
+                            .setTitle("Select Preset")
+                            .setItems(names.toTypedArray()) { _, which ->
+                                applyShaderSelection(uri, presets[which].path)
+                            }
+                            .setNegativeButton(R.string.permission_cancel, null)
+                            .show()
+                    }
+                }
+            }
+        }.start()
+    }
+
+    private fun applyShaderSelection(uri: Uri, packPreset: String?) {
         // Store the selected shader URI in the default SharedPreferences
         val prefs = androidx.preference.PreferenceManager.getDefaultSharedPreferences(this)
-        prefs.edit().putString("selected_shader_uri", uri.toString()).apply()
-        prefs.edit().putString("shader_selection", "external").apply()
+        val editor = prefs.edit()
+            .putString("selected_shader_uri", uri.toString())
+            .putString("shader_selection", "external")
+        if (packPreset != null) {
+            editor.putString("selected_pack_preset", packPreset)
+        } else {
+            editor.remove("selected_pack_preset")
+        }
+        editor.apply()
 
-        Toast.makeText(this, "Shader loaded: ${uri.lastPathSegment}", Toast.LENGTH_SHORT).show()
+        val shownName = packPreset?.substringAfterLast('/') ?: uri.lastPathSegment
+        Toast.makeText(this, "Shader loaded: $shownName", Toast.LENGTH_SHORT).show()
 
         // Update the shader display
         updateShaderDisplay()
@@ -296,7 +340,10 @@ class MainActivity : AppCompatActivity() {
         val displayText = when (shaderSelection) {
             "external" -> {
                 val shaderUri = prefs.getString("selected_shader_uri", null)
-                if (shaderUri != null) {
+                val packPreset = prefs.getString("selected_pack_preset", null)
+                if (packPreset != null) {
+                    "Current shader: ${packPreset.substringAfterLast('/').removeSuffix(".slangp")}"
+                } else if (shaderUri != null) {
                     val uri = Uri.parse(shaderUri)
                     "Current shader: ${uri.lastPathSegment ?: "external"}"
                 } else {